@@ -0,0 +1,66 @@
+#include "algorithms/cfs_scheduler.h"
+#include "util/logger.h"
+#include <string>
+
+using namespace std;
+
+
+const uint64_t CfsScheduler::WEIGHTS[4] = {9548, 3121, 1024, 335};
+
+
+CfsScheduler::CfsScheduler(size_t target_latency, size_t min_granularity)
+    : target_latency(target_latency), min_granularity(min_granularity) {}
+
+
+void CfsScheduler::skip_turns(Thread* thread, size_t turns) {
+  // each turn would have picked the thread at its virtual runtime, without it
+  // waiting at all, and charged it for the run it got. The last of them
+  // picked it for the run it is on now, which is all of its slice that the
+  // rest of its burst fills.
+  uint64_t weight = WEIGHTS[thread->type];
+  size_t slice = lone_time_slice(thread);
+  size_t last_run = min(slice, thread->remaining_burst);
+  uint64_t delta = vruntime_delta(slice, weight);
+  uint64_t& vruntime = vruntimes[thread->index];
+  vruntime += (turns - 1) * delta;
+  min_vruntime = max(min_vruntime, vruntime);
+  vruntime += vruntime_delta(last_run, weight);
+
+  TypeStats& stats = type_stats[thread->type];
+  stats.dispatches += turns;
+  stats.cpu_time += (turns - 1) * slice + last_run;
+}
+
+
+void CfsScheduler::begin_run() {
+  min_vruntime = 0;
+  for (TypeStats& stats : type_stats) {
+    stats = TypeStats();
+  }
+}
+
+
+vector<SchedulerMetric> CfsScheduler::metrics() const {
+  size_t total_cpu_time = 0;
+  for (const TypeStats& stats : type_stats) {
+    total_cpu_time += stats.cpu_time;
+  }
+
+  // how each type fared against the others, leaving out types that never ran
+  vector<SchedulerMetric> metrics;
+  for (int i = Process::SYSTEM; i <= Process::BATCH; i++) {
+    const TypeStats& stats = type_stats[i];
+    if (stats.dispatches == 0) continue;
+
+    string type = PROCESS_TYPE_MAP[i];
+    double share = total_cpu_time > 0
+        ? 100.0 * stats.cpu_time / total_cpu_time
+        : 0;
+    metrics.push_back({type + " dispatches:", double(stats.dispatches), 0});
+    metrics.push_back({type + " CPU (%):", share, 2});
+    metrics.push_back({type + " mean wait:",
+                       double(stats.total_wait) / stats.dispatches, 2});
+    metrics.push_back({type + " max wait:", double(stats.max_wait), 0});
+  }
+  return metrics;
+}
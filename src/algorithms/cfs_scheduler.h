@@ -0,0 +1,225 @@
+#pragma once
+#include "algorithms/indexed_heap.h"
+#include "algorithms/scheduler.h"
+#include "types/event.h"
+#include "types/process.h"
+#include "types/scheduling_decision.h"
+#include "types/thread.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * Represents a completely fair scheduler in the style of Linux's CFS. Each
+ * thread has a virtual runtime, which grows as it runs at a rate inversely
+ * proportional to the weight of its process type, and the thread with the
+ * least virtual runtime runs next. Its time slice is its weighted share of a
+ * target latency, within which every ready thread should get a turn, but no
+ * less than a minimum granularity, so that a long queue does not turn into
+ * nothing but thread switches.
+ */
+class CfsScheduler final : public Scheduler {
+public:
+
+  CfsScheduler(size_t target_latency, size_t min_granularity);
+
+
+  virtual SchedulingDecision* get_next_thread(const Event* event) override;
+
+
+  virtual void enqueue(const Event* event, Thread* thread) override;
+
+
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
+
+
+  virtual size_t size() const override;
+
+
+  virtual size_t lone_time_slice(const Thread* thread) const override;
+
+
+  virtual void skip_turns(Thread* thread, size_t turns) override;
+
+
+  virtual void begin_run() override;
+
+
+  virtual std::vector<SchedulerMetric> metrics() const override;
+
+private:
+
+  /**
+   * The weight of each process type, indexed by Process::Type. These are the
+   * weights Linux gives to nice values -10, -5, 0 and 5, so each type gets
+   * about three times the CPU of the next when they compete.
+   */
+  static const uint64_t WEIGHTS[4];
+
+  /**
+   * The weight of a NORMAL thread, whose virtual runtime grows as fast as
+   * real time.
+   */
+  static const uint64_t NICE_0_WEIGHT = 1024;
+
+  /**
+   * The units of virtual runtime per tick run by a NORMAL thread, which
+   * keep the rounding of heavier threads' runtimes small.
+   */
+  static const uint64_t VRUNTIME_PER_TICK = 1024;
+
+  /**
+   * Returns the time slice of a thread with the given weight when `runnable`
+   * threads with a total weight of `total_weight` share the CPU.
+   */
+  size_t time_slice(uint64_t weight, size_t runnable,
+                    uint64_t total_weight) const {
+    uint64_t period = std::max<uint64_t>(target_latency,
+                                         runnable * min_granularity);
+    return std::max<uint64_t>(period * weight / total_weight, min_granularity);
+  }
+
+  /**
+   * Returns the virtual runtime a thread with the given weight gains by
+   * running for `ran` ticks.
+   */
+  static uint64_t vruntime_delta(size_t ran, uint64_t weight) {
+    return ran * VRUNTIME_PER_TICK * NICE_0_WEIGHT / weight;
+  }
+
+  /**
+   * The period in which every ready thread should get a turn, if it can be
+   * split into slices of at least `min_granularity`.
+   */
+  const size_t target_latency;
+
+  /**
+   * The shortest time slice a thread is given.
+   */
+  const size_t min_granularity;
+
+  // the ready threads, keyed by their virtual runtime
+  IndexedHeap<uint64_t> threads;
+
+  /**
+   * The total weight of the ready threads.
+   */
+  uint64_t queued_weight = 0;
+
+  /**
+   * The virtual runtime of each thread, indexed by thread. A thread is
+   * charged for its whole turn when it is picked, since it only stops early
+   * when its burst does.
+   */
+  std::vector<uint64_t> vruntimes;
+
+  /**
+   * The time each thread was last enqueued, indexed by thread.
+   */
+  std::vector<size_t> ready_since;
+
+  /**
+   * The least virtual runtime of any thread picked so far, which never goes
+   * down. New threads start here, and threads back from I/O start no more
+   * than half a target latency behind it, so that neither can monopolize
+   * the CPU to catch up with threads that have been running all along.
+   */
+  uint64_t min_vruntime = 0;
+
+  /**
+   * What threads of one process type received during the current run.
+   */
+  struct TypeStats {
+    size_t dispatches = 0;
+    size_t cpu_time = 0;
+
+    /**
+     * The sum and the longest of the waits between being enqueued and being
+     * picked.
+     */
+    size_t total_wait = 0;
+    size_t max_wait = 0;
+  };
+
+  TypeStats type_stats[4];
+};
+
+
+// Defined here like the other built-in schedulers' per-event methods, so that
+// the engine can inline them.
+inline SchedulingDecision* CfsScheduler::get_next_thread(const Event* event) {
+  if (threads.empty()) return nullptr; // return null if there is no thread to run
+
+  ThreadIndex index = threads.top();
+  const Thread& thread = (*thread_table)[index];
+  uint64_t weight = WEIGHTS[thread.type];
+  uint64_t vruntime = threads.top_key();
+
+  SchedulingDecision* dec = new_decision();
+  dec->explanation.kind = Explanation::FAIR_SHARE;
+  dec->explanation.candidates = threads.size();
+  dec->explanation.key = (double) vruntime / VRUNTIME_PER_TICK;
+  dec->time_slice = time_slice(weight, threads.size(), queued_weight);
+  dec->thread = index;
+
+  threads.pop();
+  queued_weight -= weight;
+  min_vruntime = std::max(min_vruntime, vruntime);
+
+  // nothing preempts the thread before its slice is up, so how long it will
+  // run is already known
+  size_t ran = std::min(dec->time_slice, thread.remaining_burst);
+  vruntimes[index] = vruntime + vruntime_delta(ran, weight);
+
+  TypeStats& stats = type_stats[thread.type];
+  size_t wait = event->time - ready_since[index];
+  stats.dispatches++;
+  stats.cpu_time += ran;
+  stats.total_wait += wait;
+  stats.max_wait = std::max(stats.max_wait, wait);
+  return dec;
+}
+
+
+inline void CfsScheduler::enqueue(const Event* event, Thread* thread) {
+  ThreadIndex index = thread->index;
+  if (index >= vruntimes.size()) {
+    vruntimes.resize(index + 1, 0);
+    ready_since.resize(index + 1, 0);
+  }
+
+  // a preempted thread keeps its virtual runtime; see min_vruntime for the
+  // others
+  uint64_t& vruntime = vruntimes[index];
+  if (thread->previous_state == Thread::NEW) {
+    vruntime = min_vruntime;
+  } else if (thread->previous_state == Thread::BLOCKED) {
+    uint64_t credit = vruntime_delta(target_latency, NICE_0_WEIGHT) / 2;
+    uint64_t floor = min_vruntime > credit ? min_vruntime - credit : 0;
+    vruntime = std::max(vruntime, floor);
+  }
+
+  ready_since[index] = event->time;
+  threads.push(index, vruntime);
+  queued_weight += WEIGHTS[thread->type];
+}
+
+
+inline bool CfsScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  return false;
+}
+
+
+inline size_t CfsScheduler::size() const {
+  return threads.size();
+}
+
+
+inline size_t CfsScheduler::lone_time_slice(const Thread* thread) const {
+  uint64_t weight = WEIGHTS[thread->type];
+  return time_slice(weight, 1, weight);
+}
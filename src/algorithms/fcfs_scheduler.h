@@ -1,15 +1,15 @@
 #pragma once
+#include "algorithms/ready_list.h"
 #include "algorithms/scheduler.h"
 #include "types/event.h"
 #include "types/scheduling_decision.h"
 #include "types/thread.h"
-#include <queue>
 
 
 /**
  * Represents a scheduling queue that uses first-come, first-served.
  */
-class FcfsScheduler : public Scheduler {
+class FcfsScheduler final : public Scheduler {
 public:
 
   virtual SchedulingDecision* get_next_thread(const Event* event) override;
@@ -18,12 +18,50 @@ public:
   virtual void enqueue(const Event* event, Thread* thread) override;
 
 
-  virtual bool should_preempt_on_arrival(const Event* event) const override;
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
 
 
   virtual size_t size() const override;
 
+
+  virtual void set_thread_table(std::vector<Thread>* threads) override;
+
 private:
 
-  std::queue<Thread*> threads;
+  ReadyList threads;
 };
+
+
+// The methods called on every event are defined here rather than in the .cpp
+// file, so that the simulation engine built for this scheduler can inline them.
+inline SchedulingDecision* FcfsScheduler::get_next_thread(const Event* event) {
+  if (empty()) return nullptr; // return null if there is no thread to run
+  // Scheduling Decision, keep default time slice
+  SchedulingDecision* dec = new_decision();
+
+  // get size before popping thread
+  dec->explanation.kind = Explanation::RUN_TO_COMPLETION;
+  dec->explanation.candidates = size();
+
+  dec->thread = threads.front(); // add thread to decision
+  threads.pop();                 // remove thread from queue
+  return dec;
+}
+
+
+inline void FcfsScheduler::enqueue(const Event* event, Thread* thread) {
+  if (thread) threads.push(thread->index); // add it to the back of the queue
+}
+
+
+inline bool FcfsScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  return false; // FCFS doesn't reempt
+}
+
+
+inline size_t FcfsScheduler::size() const {
+  return threads.size(); // get the size of the queue
+}
@@ -0,0 +1,193 @@
+#pragma once
+#include "types/thread.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * A binary min-heap of threads ordered by a key, which keeps track of where
+ * each thread is. Besides pushing and popping the thread with the smallest
+ * key, any thread can be removed or have its key changed, all in O(log n).
+ * Threads with equal keys come out in the order they were pushed, so that
+ * ties are broken first-come, first-served.
+ */
+template <typename Key>
+class IndexedHeap {
+public:
+
+  /**
+   * Adds a thread, which must not already be in the heap.
+   */
+  void push(ThreadIndex thread, Key key) {
+    if (thread >= positions.size()) positions.resize(thread + 1, NOT_IN_HEAP);
+    assert(positions[thread] == NOT_IN_HEAP);
+
+    Entry entry;
+    entry.key = key;
+    entry.order = next_order++;
+    entry.thread = thread;
+    entries.push_back(entry);
+    sift_up(entries.size() - 1);
+  }
+
+  /**
+   * Returns the thread with the smallest key. The heap must not be empty.
+   */
+  ThreadIndex top() const {
+    assert(!entries.empty());
+    return entries[0].thread;
+  }
+
+  /**
+   * Returns the smallest key. The heap must not be empty.
+   */
+  Key top_key() const {
+    assert(!entries.empty());
+    return entries[0].key;
+  }
+
+  /**
+   * Removes and returns the thread with the smallest key. The heap must not
+   * be empty.
+   */
+  ThreadIndex pop() {
+    ThreadIndex thread = top();
+    remove_at(0);
+    return thread;
+  }
+
+  /**
+   * Removes a thread from anywhere in the heap. The thread must be in it.
+   */
+  void remove(ThreadIndex thread) {
+    assert(contains(thread));
+    remove_at(positions[thread]);
+  }
+
+  /**
+   * Changes the key of a thread in the heap, moving it up if the key
+   * decreased or down if it increased. The thread keeps its place among
+   * threads with the same key.
+   */
+  void update(ThreadIndex thread, Key key) {
+    assert(contains(thread));
+    uint32_t position = positions[thread];
+    Key old_key = entries[position].key;
+    entries[position].key = key;
+    if (key < old_key) {
+      sift_up(position);
+    } else {
+      sift_down(position);
+    }
+  }
+
+  /**
+   * Returns whether the thread is in the heap.
+   */
+  bool contains(ThreadIndex thread) const {
+    return thread < positions.size() && positions[thread] != NOT_IN_HEAP;
+  }
+
+  /**
+   * Returns the key of a thread in the heap.
+   */
+  Key key(ThreadIndex thread) const {
+    assert(contains(thread));
+    return entries[positions[thread]].key;
+  }
+
+  size_t size() const { return entries.size(); }
+
+  bool empty() const { return entries.empty(); }
+
+private:
+
+  /**
+   * The position of a thread that is not in the heap.
+   */
+  static const uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+  struct Entry {
+    Key key;
+
+    /**
+     * When the thread was pushed, which breaks ties between equal keys.
+     */
+    uint64_t order;
+
+    ThreadIndex thread;
+  };
+
+  bool less(const Entry& a, const Entry& b) const {
+    return a.key < b.key || (!(b.key < a.key) && a.order < b.order);
+  }
+
+  // puts an entry in its place and records where it went
+  void place(size_t position, const Entry& entry) {
+    entries[position] = entry;
+    positions[entry.thread] = position;
+  }
+
+  void sift_up(size_t position) {
+    Entry entry = entries[position];
+    while (position > 0) {
+      size_t parent = (position - 1) / 2;
+      if (!less(entry, entries[parent])) break;
+      place(position, entries[parent]);
+      position = parent;
+    }
+    place(position, entry);
+  }
+
+  void sift_down(size_t position) {
+    Entry entry = entries[position];
+    size_t count = entries.size();
+    while (true) {
+      size_t child = position * 2 + 1;
+      if (child >= count) break;
+      if (child + 1 < count && less(entries[child + 1], entries[child])) child++;
+      if (!less(entries[child], entry)) break;
+      place(position, entries[child]);
+      position = child;
+    }
+    place(position, entry);
+  }
+
+  // removes the entry at the given position by moving the last entry into
+  // its place
+  void remove_at(size_t position) {
+    positions[entries[position].thread] = NOT_IN_HEAP;
+    Entry last = entries.back();
+    entries.pop_back();
+    if (position == entries.size()) return;
+
+    entries[position] = last;
+    if (position > 0 && less(last, entries[(position - 1) / 2])) {
+      sift_up(position);
+    } else {
+      sift_down(position);
+    }
+  }
+
+  /**
+   * The heap itself, with the smallest entry first.
+   */
+  std::vector<Entry> entries;
+
+  /**
+   * The position of each thread in `entries`, indexed by thread, or
+   * NOT_IN_HEAP.
+   */
+  std::vector<uint32_t> positions;
+
+  /**
+   * The order to give to the next thread pushed.
+   */
+  uint64_t next_order = 0;
+};
+
+
+template <typename Key>
+const uint32_t IndexedHeap<Key>::NOT_IN_HEAP;
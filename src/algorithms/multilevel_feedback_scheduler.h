@@ -1,20 +1,19 @@
 #pragma once
+#include "algorithms/multilevel_queue.h"
 #include "algorithms/scheduler.h"
 #include "types/event.h"
 #include "types/scheduling_decision.h"
 #include "types/thread.h"
-#include "algorithms/round_robin_scheduler.h"
-#include <vector>
-#include <map>
+#include <algorithm>
 
 
 /**
  * Represents a scheduling queue that demotes threads after being preempted.
  */
-class MultilevelFeedbackScheduler : public Scheduler {
+class MultilevelFeedbackScheduler final : public Scheduler {
 public:
 
-  MultilevelFeedbackScheduler();
+  MultilevelFeedbackScheduler(size_t time_slice = 3, size_t num_levels = 8);
 
 
   virtual SchedulingDecision* get_next_thread(const Event* event) override;
@@ -23,22 +22,95 @@ public:
   virtual void enqueue(const Event* event, Thread* thread) override;
 
 
-  virtual bool should_preempt_on_arrival(const Event* event) const override;
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
 
 
   virtual size_t size() const override;
 
+
+  virtual size_t lone_time_slice(const Thread* thread) const override;
+
+
+  virtual void skip_turns(Thread* thread, size_t turns) override;
+
+
+  virtual void set_thread_table(std::vector<Thread>* threads) override;
+
 private:
-  // implement 8 levels of queues
-  const int NUM_QUEUES = 8;
-  // give them a constant time slice, the same as the default round robin scheduler
-  const int TIME_SLICE = 3;
-
-  // since a MLFQ is implemented with several RR queues, we can use those instead of making more
-  // queues
-  std::vector<RoundRobinScheduler*> queues;
-  
-  // use a map to save the queue level of the thread and update when it gets enqueued.
-  // the levels start at 0 and go to NUM_QUEUES-1
-  std::map<Thread*, int> level_map;
+  // 8 levels of queues by default
+  const int NUM_QUEUES;
+  // every level uses the same time slice, 3 by default like the round robin scheduler
+  const size_t TIME_SLICE;
+
+  // one round-robin queue per level
+  MultilevelQueue<> queues;
+
+  // the level of each thread is saved in Thread::queue_level and updated when it gets
+  // enqueued. the levels start at 0 and go to NUM_QUEUES-1
 };
+
+
+// Enqueueing and picking a thread happen on every event; see FcfsScheduler.
+inline SchedulingDecision* MultilevelFeedbackScheduler::get_next_thread(
+    const Event* event) {
+  if (queues.empty()) return nullptr; // return null if there is no thread to run
+
+  // take the first thread from the highest level that isn't empty, and give
+  // it a time slice like round robin would
+  size_t level = queues.first_level();
+  SchedulingDecision* dec = new_decision();
+  dec->explanation.kind = Explanation::FEEDBACK_LEVEL;
+  dec->explanation.candidates = queues.size(level);
+  dec->explanation.level = level;
+  dec->explanation.num_levels = NUM_QUEUES;
+  dec->thread = queues.pop(level);
+  dec->time_slice = TIME_SLICE;
+  return dec;
+}
+
+
+inline void MultilevelFeedbackScheduler::enqueue(
+    const Event* event, Thread* thread) {
+  int level;
+  if (thread->queue_level < 0) {
+    // the thread hasn't been in a queue yet, so add it to the level
+    // corresponding to it's priority
+    level = thread->type;
+  } else {
+    // increment the level
+    level = thread->queue_level + 1;
+    // check if the level is still in the bounds of the scheduler
+    if (level >= NUM_QUEUES) level = NUM_QUEUES - 1;
+  }
+  // enqueue the thread in the corresponding level and remember the level
+  queues.push(level, thread->index);
+  thread->queue_level = level;
+}
+
+
+inline bool MultilevelFeedbackScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  return false; // doesn't preempt on arrival
+}
+
+
+inline size_t MultilevelFeedbackScheduler::size() const {
+  return queues.size();
+}
+
+
+inline size_t MultilevelFeedbackScheduler::lone_time_slice(
+    const Thread* thread) const {
+  return TIME_SLICE; // every level uses the same time slice
+}
+
+
+inline void MultilevelFeedbackScheduler::skip_turns(Thread* thread,
+                                                    size_t turns) {
+  // each turn demotes the thread by one level, until it reaches the bottom
+  assert(thread->queue_level >= 0);
+  size_t level = thread->queue_level + turns;
+  thread->queue_level = (int) std::min(level, (size_t) NUM_QUEUES - 1);
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "algorithms/ready_list.h"
+#include "types/thread.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * A set of FIFO ready queues, one per level, where level 0 is served first.
+ * A bitmap records which levels are non-empty, so finding the first thread to
+ * run takes two find-first-set instructions however many levels there are,
+ * and the total number of queued threads is kept as they come and go.
+ *
+ * `Queue` must provide set_thread_table(), push(), front(), pop(), remove(),
+ * size() and empty() over ThreadIndex, as ReadyList does.
+ */
+template <typename Queue = ReadyList>
+class MultilevelQueue {
+public:
+
+  /**
+   * The most levels a queue can have: one bit of the summary word for each
+   * word of the bitmap.
+   */
+  static const size_t MAX_LEVELS = 64 * 64;
+
+  explicit MultilevelQueue(size_t num_levels)
+      : levels(num_levels), bitmap((num_levels + 63) / 64, 0) {
+    assert(num_levels > 0 && num_levels <= MAX_LEVELS);
+  }
+
+  /**
+   * Sets the table that the queue's thread indices refer to.
+   */
+  void set_thread_table(std::vector<Thread>* threads) {
+    for (Queue& queue : levels) queue.set_thread_table(threads);
+  }
+
+  /**
+   * Adds a thread to the back of the given level.
+   */
+  void push(size_t level, ThreadIndex thread) {
+    levels[level].push(thread);
+    bitmap[level / 64] |= uint64_t(1) << (level % 64);
+    summary |= uint64_t(1) << (level / 64);
+    count++;
+  }
+
+  /**
+   * Returns the lowest-numbered level with a thread in it. The queue must
+   * not be empty.
+   */
+  size_t first_level() const {
+    assert(count > 0);
+    size_t word = __builtin_ctzll(summary);
+    return word * 64 + __builtin_ctzll(bitmap[word]);
+  }
+
+  /**
+   * Removes and returns the thread at the front of the given level, which
+   * must not be empty.
+   */
+  ThreadIndex pop(size_t level) {
+    Queue& queue = levels[level];
+    ThreadIndex thread = queue.front();
+    queue.pop();
+    count--;
+    if (queue.empty()) clear_level(level);
+    return thread;
+  }
+
+  /**
+   * Removes a thread from the given level, which it must be in.
+   */
+  void remove(size_t level, ThreadIndex thread) {
+    Queue& queue = levels[level];
+    queue.remove(thread);
+    count--;
+    if (queue.empty()) clear_level(level);
+  }
+
+  /**
+   * Returns the number of threads in every level.
+   */
+  size_t size() const { return count; }
+
+  /**
+   * Returns the number of threads in the given level.
+   */
+  size_t size(size_t level) const { return levels[level].size(); }
+
+  bool empty() const { return count == 0; }
+
+  size_t num_levels() const { return levels.size(); }
+
+private:
+
+  /**
+   * Marks a level that has just become empty.
+   */
+  void clear_level(size_t level) {
+    bitmap[level / 64] &= ~(uint64_t(1) << (level % 64));
+    if (bitmap[level / 64] == 0) summary &= ~(uint64_t(1) << (level / 64));
+  }
+
+  /**
+   * The queue of each level.
+   */
+  std::vector<Queue> levels;
+
+  /**
+   * One bit per level, set while the level has threads in it.
+   */
+  std::vector<uint64_t> bitmap;
+
+  /**
+   * One bit per word of `bitmap`, set while the word is non-zero.
+   */
+  uint64_t summary = 0;
+
+  /**
+   * The number of threads in every level.
+   */
+  size_t count = 0;
+};
@@ -1,16 +1,16 @@
 #pragma once
+#include "algorithms/multilevel_queue.h"
 #include "algorithms/scheduler.h"
 #include "types/event.h"
 #include "types/scheduling_decision.h"
 #include "types/thread.h"
-#include "algorithms/fcfs_scheduler.h"
 
 
 /**
  * Represents a scheduling queue that gives threads of each type a different
  * priority.
  */
-class PriorityScheduler : public Scheduler {
+class PriorityScheduler final : public Scheduler {
 public:
 
   PriorityScheduler();
@@ -22,15 +22,58 @@ public:
   virtual void enqueue(const Event* event, Thread* thread) override;
 
 
-  virtual bool should_preempt_on_arrival(const Event* event) const override;
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
 
 
   virtual size_t size() const override;
 
+
+  virtual void set_thread_table(std::vector<Thread>* threads) override;
+
 private:
   // make the number of priority levels into a variable
   const int NUM_PRIORITIES = 4;
 
-  // create a vector of FCFS schedulers
-  std::vector<FcfsScheduler*> queues;
+  // one FCFS queue per priority level, indexed by process type
+  MultilevelQueue<> queues;
 };
+
+
+// Called on every event, so defined inline for the engine built for this
+// scheduler.
+inline SchedulingDecision* PriorityScheduler::get_next_thread(
+    const Event* event) {
+  if (queues.empty()) return nullptr; // return null if there is no thread to run
+
+  // take the first thread from the highest priority queue that isn't empty
+  size_t level = queues.first_level();
+  SchedulingDecision* dec = new_decision();
+  dec->explanation.kind = Explanation::PRIORITY_QUEUE;
+  dec->explanation.level = level;
+  dec->explanation.candidates = queues.size(level);
+  dec->thread = queues.pop(level);
+
+  for (int j = 0; j < NUM_PRIORITIES; j++) {
+    dec->explanation.queue_sizes[j] = queues.size(j);
+  }
+  return dec;
+}
+
+
+inline void PriorityScheduler::enqueue(const Event* event, Thread* thread) {
+  // add the thread into the queue with the priority of the process it belongs to
+  queues.push(thread->type, thread->index);
+}
+
+
+inline bool PriorityScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  return false; // does not preempt on arrival
+}
+
+
+inline size_t PriorityScheduler::size() const {
+  return queues.size();
+}
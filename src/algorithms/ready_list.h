@@ -0,0 +1,94 @@
+#pragma once
+#include "types/thread.h"
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * A first-in, first-out queue of threads, linked through the ready_prev and
+ * ready_next fields of the threads themselves. A thread is in at most one
+ * ready list at a time, so the links cost nothing extra, and pushing, popping
+ * and removing any thread are O(1) and never allocate.
+ */
+class ReadyList {
+public:
+
+  /**
+   * Sets the table that the list's thread indices refer to. Must be called
+   * before the first push.
+   */
+  void set_thread_table(std::vector<Thread>* threads) { this->threads = threads; }
+
+  /**
+   * Adds a thread to the back of the list.
+   */
+  void push(ThreadIndex index) {
+    Thread& thread = (*threads)[index];
+    assert(thread.ready_prev == NO_THREAD && thread.ready_next == NO_THREAD);
+    thread.ready_prev = tail;
+    if (tail == NO_THREAD) {
+      head = index;
+    } else {
+      (*threads)[tail].ready_next = index;
+    }
+    tail = index;
+    count++;
+  }
+
+  /**
+   * Returns the thread at the front of the list, which must not be empty.
+   */
+  ThreadIndex front() const {
+    assert(count > 0);
+    return head;
+  }
+
+  /**
+   * Removes the thread at the front of the list, which must not be empty.
+   */
+  void pop() { remove(head); }
+
+  /**
+   * Removes a thread from anywhere in the list. The thread must be in this
+   * list.
+   */
+  void remove(ThreadIndex index) {
+    Thread& thread = (*threads)[index];
+    if (thread.ready_prev == NO_THREAD) {
+      head = thread.ready_next;
+    } else {
+      (*threads)[thread.ready_prev].ready_next = thread.ready_next;
+    }
+    if (thread.ready_next == NO_THREAD) {
+      tail = thread.ready_prev;
+    } else {
+      (*threads)[thread.ready_next].ready_prev = thread.ready_prev;
+    }
+    thread.ready_prev = NO_THREAD;
+    thread.ready_next = NO_THREAD;
+    count--;
+  }
+
+  size_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+private:
+
+  /**
+   * The table that the list's thread indices refer to.
+   */
+  std::vector<Thread>* threads = nullptr;
+
+  /**
+   * The first and last threads in the list, or NO_THREAD if it is empty.
+   */
+  ThreadIndex head = NO_THREAD;
+  ThreadIndex tail = NO_THREAD;
+
+  /**
+   * The number of threads in the list.
+   */
+  size_t count = 0;
+};
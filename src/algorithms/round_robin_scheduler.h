@@ -9,7 +9,7 @@
 /**
  * Represents a scheduling queue that uses simple round-robin.
  */
-class RoundRobinScheduler : public Scheduler {
+class RoundRobinScheduler final : public Scheduler {
 public:
 
   RoundRobinScheduler(size_t time_slice) : time_slice(time_slice) {}
@@ -21,11 +21,22 @@ public:
   virtual void enqueue(const Event* event, Thread* thread) override;
 
 
-  virtual bool should_preempt_on_arrival(const Event* event) const override;
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
 
 
   virtual size_t size() const override;
 
+
+  virtual size_t lone_time_slice(const Thread* thread) const override;
+
+
+  virtual void set_decision_pool(ObjectPool<SchedulingDecision>* pool) override;
+
+
+  virtual void set_thread_table(std::vector<Thread>* threads) override;
+
 private:
 
   /**
@@ -37,3 +48,39 @@ private:
   // have already been made in a FCFS scheduler
   FcfsScheduler scheduler;
 };
+
+
+// Defined inline so that the engine for RR inlines them, along with the FCFS
+// methods they forward to.
+inline SchedulingDecision* RoundRobinScheduler::get_next_thread(
+    const Event* event) {
+  // get the next thread based on the underlying fcfs queue
+  SchedulingDecision* dec = scheduler.get_next_thread(event);
+  // set the time slice if a desicion has been made
+  if (dec != nullptr) {
+    dec->time_slice = time_slice;
+    dec->explanation.kind = Explanation::TIME_SLICED;
+  }
+  return dec;
+}
+
+
+inline void RoundRobinScheduler::enqueue(const Event* event, Thread* thread) {
+  scheduler.enqueue(event, thread);
+}
+
+
+inline bool RoundRobinScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  return false; // RR doesn't preempt on arrival
+}
+
+
+inline size_t RoundRobinScheduler::size() const {
+  return scheduler.size();
+}
+
+
+inline size_t RoundRobinScheduler::lone_time_slice(const Thread* thread) const {
+  return time_slice; // every turn gets the same slice, and FCFS keeps no state
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include "types/event.h"
+#include "types/scheduler_metric.h"
 #include "types/scheduling_decision.h"
 #include "types/thread.h"
+#include "util/object_pool.h"
+#include <vector>
 
 
 /**
@@ -20,11 +23,16 @@ struct Scheduler {
   virtual void enqueue(const Event* event, Thread* thread) = 0;
 
   /**
-   * Returns true if the currently running thread should be preempted upon the
-   * arrival of the given thread, as represented by event. Ususally used for
-   * shortest process next.
+   * Returns true if the running thread should be preempted now that another
+   * thread has become ready, by arriving or finishing its I/O. `event` is the
+   * event that made it ready, or the end of the running thread's dispatch if
+   * it became ready during the dispatch. The new thread has already been
+   * enqueued, and `remaining` is the time left in the running thread's CPU
+   * burst. Ususally used for shortest remaining time first.
    */
-  virtual bool should_preempt_on_arrival(const Event* event) const = 0;
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const = 0;
 
   /**
    * Returns the number of threads in this scheduler's ready queues.
@@ -36,8 +44,73 @@ struct Scheduler {
    */
   bool empty() const { return size() == 0; }
 
+  /**
+   * Returns the time slice that the given thread would be given every time
+   * it was preempted, enqueued and picked again with no other thread ready,
+   * or 0 if that cannot be promised. Lets the simulation skip over the turns
+   * of a long CPU burst on an otherwise idle system.
+   */
+  virtual size_t lone_time_slice(const Thread* thread) const { return 0; }
+
+  /**
+   * Brings the scheduler's record of the given thread up to date as though
+   * it had been enqueued and picked `turns` times with no other thread
+   * ready. Only called after lone_time_slice() promised a time slice.
+   */
+  virtual void skip_turns(Thread* thread, size_t turns) {}
+
+  /**
+   * Called at the start of every run, while the ready queues are empty.
+   * Schedulers that keep figures about a run start them again here.
+   */
+  virtual void begin_run() {}
+
+  /**
+   * Returns the figures this scheduler kept about the current run, if any,
+   * to be printed with the run's statistics.
+   */
+  virtual std::vector<SchedulerMetric> metrics() const { return {}; }
+
+  /**
+   * Sets the pool that scheduling decisions are allocated from. Schedulers
+   * that delegate to other schedulers should pass the pool along to them.
+   */
+  virtual void set_decision_pool(ObjectPool<SchedulingDecision>* pool) {
+    decision_pool = pool;
+  }
+
+  /**
+   * Sets the table that the thread indices in this scheduler's queues refer
+   * to. Must be called before the first thread is enqueued, and again if the
+   * table is replaced. Schedulers that delegate to other schedulers or queues
+   * should pass the table along to them.
+   */
+  virtual void set_thread_table(std::vector<Thread>* threads) {
+    thread_table = threads;
+  }
+
   /**
    * Virtual destructor (as a best practice).
    */
   virtual ~Scheduler() {}
+
+protected:
+
+  /**
+   * Returns a new, empty scheduling decision from the decision pool, or from
+   * the heap if no pool has been set.
+   */
+  SchedulingDecision* new_decision() {
+    return decision_pool ? decision_pool->acquire() : new SchedulingDecision();
+  }
+
+  /**
+   * The pool that scheduling decisions are allocated from, or NULL.
+   */
+  ObjectPool<SchedulingDecision>* decision_pool = nullptr;
+
+  /**
+   * The table that thread indices refer to, or NULL.
+   */
+  std::vector<Thread>* thread_table = nullptr;
 };
@@ -0,0 +1,34 @@
+#include "algorithms/spn_scheduler.h"
+#include <cmath>
+
+using namespace std;
+
+
+SpnScheduler::SpnScheduler(double alpha, double initial_guess)
+    : alpha(alpha), initial_guess(initial_guess) {}
+
+
+void SpnScheduler::begin_run() {
+  num_predicted = 0;
+  total_error = 0;
+  total_absolute_error = 0;
+  total_squared_error = 0;
+  total_actual = 0;
+}
+
+
+vector<SchedulerMetric> SpnScheduler::metrics() const {
+  double count = num_predicted > 0 ? num_predicted : 1;
+  double mean_actual = total_actual / count;
+  double mean_absolute_error = total_absolute_error / count;
+
+  return {
+    {"Bursts predicted:", double(num_predicted), 0},
+    {"Mean burst:", mean_actual, 2},
+    {"Mean error:", total_error / count, 2},
+    {"Mean absolute error:", mean_absolute_error, 2},
+    {"Root mean sq. error:", sqrt(total_squared_error / count), 2},
+    {"Relative error (%):",
+     mean_actual > 0 ? 100 * mean_absolute_error / mean_actual : 0, 2}
+  };
+}
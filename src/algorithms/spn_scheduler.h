@@ -0,0 +1,129 @@
+#pragma once
+#include "algorithms/indexed_heap.h"
+#include "algorithms/scheduler.h"
+#include "types/event.h"
+#include "types/scheduling_decision.h"
+#include "types/thread.h"
+#include <vector>
+
+
+/**
+ * Represents a scheduling queue that runs the thread expected to have the
+ * shortest next CPU burst, without preempting it. A thread's first burst is
+ * expected to take `initial_guess` ticks, and every burst it completes moves
+ * the expectation towards what actually happened:
+ *
+ *     prediction = alpha * last burst + (1 - alpha) * prediction
+ *
+ * so recent bursts count for more than old ones.
+ */
+class SpnScheduler final : public Scheduler {
+public:
+
+  SpnScheduler(double alpha, double initial_guess);
+
+
+  virtual SchedulingDecision* get_next_thread(const Event* event) override;
+
+
+  virtual void enqueue(const Event* event, Thread* thread) override;
+
+
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
+
+
+  virtual size_t size() const override;
+
+
+  virtual void begin_run() override;
+
+
+  virtual std::vector<SchedulerMetric> metrics() const override;
+
+private:
+
+  /**
+   * The weight given to the most recent burst, between 0 and 1.
+   */
+  const double alpha;
+
+  /**
+   * The prediction for a thread that has not run yet.
+   */
+  const double initial_guess;
+
+  // the ready threads, keyed by their predicted burst
+  IndexedHeap<double> threads;
+
+  /**
+   * The predicted length of each thread's next CPU burst, indexed by thread.
+   * Only meaningful from the thread's arrival onwards.
+   */
+  std::vector<double> predictions;
+
+  /**
+   * The number of bursts dispatched in this run, and the sums of their
+   * prediction errors (prediction minus actual length), absolute errors and
+   * squared errors.
+   */
+  size_t num_predicted = 0;
+  double total_error = 0;
+  double total_absolute_error = 0;
+  double total_squared_error = 0;
+
+  /**
+   * The sum of the actual lengths of the bursts dispatched in this run.
+   */
+  double total_actual = 0;
+};
+
+
+// Defined here like the other built-in schedulers' per-event methods, so that
+// the engine can inline them.
+inline SchedulingDecision* SpnScheduler::get_next_thread(const Event* event) {
+  if (threads.empty()) return nullptr; // return null if there is no thread to run
+
+  SchedulingDecision* dec = new_decision();
+  dec->explanation.kind = Explanation::SHORTEST_PREDICTED;
+  dec->explanation.candidates = threads.size();
+  dec->explanation.key = threads.top_key();
+  dec->thread = threads.pop();
+
+  // the thread is never preempted, so the whole burst is about to run; the
+  // next prediction can be made now, since nothing reads it until the
+  // thread is enqueued again after this burst
+  double predicted = dec->explanation.key;
+  double actual = (*thread_table)[dec->thread].remaining_burst;
+  double error = predicted - actual;
+  num_predicted++;
+  total_error += error;
+  total_absolute_error += error < 0 ? -error : error;
+  total_squared_error += error * error;
+  total_actual += actual;
+  predictions[dec->thread] = alpha * actual + (1 - alpha) * predicted;
+  return dec;
+}
+
+
+inline void SpnScheduler::enqueue(const Event* event, Thread* thread) {
+  // thread indices are reused when streaming, so a thread starting its first
+  // burst gets a fresh prediction rather than one left by an earlier thread
+  if (thread->index >= predictions.size()) {
+    predictions.resize(thread->index + 1, initial_guess);
+  }
+  if (thread->burst_index == 0) predictions[thread->index] = initial_guess;
+  threads.push(thread->index, predictions[thread->index]);
+}
+
+
+inline bool SpnScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  return false;
+}
+
+
+inline size_t SpnScheduler::size() const {
+  return threads.size();
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "algorithms/indexed_heap.h"
+#include "algorithms/scheduler.h"
+#include "types/event.h"
+#include "types/scheduling_decision.h"
+#include "types/thread.h"
+
+
+/**
+ * Represents a scheduling queue that runs the thread with the least time left
+ * in its CPU burst, and preempts the running thread when one with less time
+ * left becomes ready.
+ */
+class SrtfScheduler final : public Scheduler {
+public:
+
+  virtual SchedulingDecision* get_next_thread(const Event* event) override;
+
+
+  virtual void enqueue(const Event* event, Thread* thread) override;
+
+
+  virtual bool should_preempt_on_arrival(const Event* event,
+                                         const Thread* running,
+                                         size_t remaining) const override;
+
+
+  virtual size_t size() const override;
+
+private:
+
+  // the ready threads, keyed by the time left in their current CPU burst
+  IndexedHeap<size_t> threads;
+};
+
+
+// Defined here like the other built-in schedulers' per-event methods, so that
+// the engine can inline them.
+inline SchedulingDecision* SrtfScheduler::get_next_thread(const Event* event) {
+  if (threads.empty()) return nullptr; // return null if there is no thread to run
+
+  // no time slice: the thread runs until its burst completes or a shorter
+  // one takes over
+  SchedulingDecision* dec = new_decision();
+  dec->explanation.kind = Explanation::SHORTEST_REMAINING;
+  dec->explanation.candidates = threads.size();
+  dec->explanation.key = threads.top_key();
+  dec->thread = threads.pop();
+  return dec;
+}
+
+
+inline void SrtfScheduler::enqueue(const Event* event, Thread* thread) {
+  // a preempted thread has already been charged for the time it ran
+  threads.push(thread->index, thread->remaining_burst);
+}
+
+
+inline bool SrtfScheduler::should_preempt_on_arrival(
+    const Event* event, const Thread* running, size_t remaining) const {
+  // only a strictly shorter thread takes over, so equal threads don't take
+  // turns forever
+  return !threads.empty() && threads.top_key() < remaining;
+}
+
+
+inline size_t SrtfScheduler::size() const {
+  return threads.size();
+}
@@ -0,0 +1,257 @@
+#include "benchmark.h"
+#include "simulation.h"
+#include "types/benchmark_result.h"
+#include "util/binary_workload.h"
+#include "util/workload_generator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * The number of processes in each workload of the corpus.
+ */
+static const vector<size_t> CORPUS_SIZES = {1000, 10000, 50000};
+
+
+// returns the options used to generate the corpus workload of the given size
+static GeneratorOptions corpus_options(const string& corpus, size_t size) {
+  GeneratorOptions options;
+  options.output = corpus + "/gen-" + to_string(size) + ".simbin";
+  options.binary = true;
+  options.num_processes = size;
+  // about 80% utilization, so ready queues stay bounded
+  options.mean_interarrival = 80;
+  return options;
+}
+
+
+// Simulates the workload `repeats` times in a child process, so that each
+// benchmark's peak RSS is its own, and passes the engine statistics of the
+// median run back through a pipe. The workload is read once and replayed.
+static bool run_isolated(const string& filename, const string& algorithm,
+                         const string& event_queue, size_t repeats,
+                         EngineStats& stats) {
+  int fds[2];
+  if (pipe(fds) != 0) return false;
+
+  pid_t child = fork();
+  if (child < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+
+  if (child == 0) {
+    close(fds[0]);
+    MappedFile file(filename);
+    Workload workload = read_binary_workload(file, filename);
+
+    unique_ptr<Scheduler> scheduler(instantiate_scheduler(algorithm));
+    unique_ptr<EventQueue> events(instantiate_event_queue(event_queue));
+    unique_ptr<Simulation> simulation(instantiate_simulation(
+        scheduler.get(), events.get(), Logger(false, false, false)));
+
+    vector<EngineStats> runs;
+    for (size_t r = 0; r < repeats; r++) {
+      simulation->simulate(workload);
+      runs.push_back(simulation->engine_statistics());
+    }
+
+    // Report the median repetition, which a single disturbed run cannot
+    // move the way it moves the fastest or the mean. Later runs reuse what
+    // the first one allocated, so its allocation count is the one reported.
+    EngineStats result = runs[0];
+    sort(runs.begin(), runs.end(),
+         [](const EngineStats& r1, const EngineStats& r2) {
+           return r1.seconds < r2.seconds;
+         });
+    size_t num_allocations = result.num_allocations;
+    double allocations_per_event = result.allocations_per_event;
+    result = runs[runs.size() / 2];
+    result.num_allocations = num_allocations;
+    result.allocations_per_event = allocations_per_event;
+
+    bool sent = write(fds[1], &result, sizeof(result)) == sizeof(result);
+    _exit(sent ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  close(fds[1]);
+  bool received = read(fds[0], &stats, sizeof(stats)) == sizeof(stats);
+  close(fds[0]);
+
+  int status;
+  waitpid(child, &status, 0);
+  return received && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+
+// reads a baseline written by write_baseline(), or nothing if there is none
+static vector<BenchmarkResult> read_baseline(const string& filename) {
+  vector<BenchmarkResult> results;
+  ifstream file(filename.c_str());
+  string line;
+
+  // skip the header
+  getline(file, line);
+
+  while (getline(file, line)) {
+    char algorithm[64];
+    BenchmarkResult result;
+    EngineStats& stats = result.stats;
+    if (sscanf(line.c_str(), "%63[^,],%lu,%lu,%lf,%lf,%lu,%lu",
+               algorithm, &result.num_processes, &stats.num_events,
+               &stats.seconds, &stats.events_per_second, &stats.peak_rss_kb,
+               &stats.num_allocations) == 7) {
+      result.algorithm = algorithm;
+      results.push_back(result);
+    }
+  }
+
+  return results;
+}
+
+
+static bool write_baseline(const string& filename,
+                           const vector<BenchmarkResult>& results) {
+  ofstream file(filename.c_str());
+  file << fixed << setprecision(4);
+  file << "algorithm,processes,events,seconds,events_per_second,peak_rss_kb,"
+          "allocations\n";
+  for (const BenchmarkResult& result : results) {
+    const EngineStats& stats = result.stats;
+    file << result.algorithm << "," << result.num_processes << ","
+         << stats.num_events << "," << stats.seconds << ","
+         << (size_t) stats.events_per_second << "," << stats.peak_rss_kb << ","
+         << stats.num_allocations << "\n";
+  }
+  return file.good();
+}
+
+
+// describes how the result is worse than the baseline in the columns that
+// come out the same on every run, or returns "" if it is no worse
+static string find_regressions(const BenchmarkResult& result,
+                               const BenchmarkResult& baseline,
+                               double tolerance) {
+  string regressions;
+  const EngineStats& now = result.stats;
+  const EngineStats& then = baseline.stats;
+
+  if (now.num_events != then.num_events) {
+    regressions += "DIFFERENT EVENTS ";
+  }
+  // page-level noise from the allocator makes the peak RSS vary slightly
+  if (now.peak_rss_kb > then.peak_rss_kb * (1 + tolerance)) {
+    regressions += "MORE MEMORY ";
+  }
+  if (now.num_allocations > then.num_allocations) {
+    regressions += "MORE ALLOCATIONS ";
+  }
+
+  if (!regressions.empty()) regressions.pop_back();
+  return regressions;
+}
+
+
+// warns if the result is slower than the baseline allows, or returns "". The
+// speed of a run depends on what else the machine is doing, so a slowdown is
+// reported but does not fail the benchmark.
+static string find_warnings(const BenchmarkResult& result,
+                            const BenchmarkResult& baseline,
+                            double tolerance) {
+  if (result.stats.events_per_second
+      < baseline.stats.events_per_second * (1 - tolerance)) {
+    return "slower";
+  }
+  return "";
+}
+
+
+int run_benchmarks(const BenchmarkOptions& options) {
+  if (mkdir(options.corpus.c_str(), 0777) != 0 && errno != EEXIST) {
+    cerr << "Unable to create corpus directory: " << options.corpus << endl;
+    return EXIT_FAILURE;
+  }
+
+  // the corpus is generated once and reused, so every run sees the same input
+  for (size_t size : CORPUS_SIZES) {
+    GeneratorOptions generator = corpus_options(options.corpus, size);
+    struct stat info;
+    if (stat(generator.output.c_str(), &info) != 0) {
+      cout << "Generating " << generator.output << endl;
+      generate_workload(generator);
+    }
+  }
+
+  vector<BenchmarkResult> baseline;
+  if (!options.update) {
+    baseline = read_baseline(options.baseline);
+    if (baseline.empty()) {
+      cout << "No baseline in " << options.baseline
+           << "; run with --update to save one." << endl;
+    }
+  }
+
+  Logger logger(false, false, false);
+  logger.print_benchmark_header();
+
+  vector<BenchmarkResult> results;
+  bool regressed = false;
+
+  for (const string& algorithm : SCHEDULER_NAMES) {
+    for (size_t size : CORPUS_SIZES) {
+      string filename = corpus_options(options.corpus, size).output;
+      BenchmarkResult result;
+      result.algorithm = algorithm;
+      result.num_processes = size;
+
+      if (!run_isolated(filename, algorithm, options.event_queue,
+                        options.repeats, result.stats)) {
+        cerr << "Benchmark of " << algorithm << " on " << filename
+             << " failed" << endl;
+        return EXIT_FAILURE;
+      }
+
+      const BenchmarkResult* previous = nullptr;
+      for (const BenchmarkResult& candidate : baseline) {
+        if (candidate.algorithm == algorithm && candidate.num_processes == size) {
+          previous = &candidate;
+        }
+      }
+
+      string regressions;
+      string warnings;
+      if (previous != nullptr) {
+        regressions = find_regressions(result, *previous, options.tolerance);
+        warnings = find_warnings(result, *previous, options.tolerance);
+        regressed = regressed || !regressions.empty();
+      }
+
+      logger.print_benchmark_row(result, previous, regressions, warnings);
+      results.push_back(result);
+    }
+  }
+
+  if (options.update) {
+    if (!write_baseline(options.baseline, results)) {
+      cerr << "Unable to write baseline: " << options.baseline << endl;
+      return EXIT_FAILURE;
+    }
+    cout << "Saved baseline to " << options.baseline << endl;
+  }
+
+  return regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "util/flags.h"
+
+
+/**
+ * Benchmarks every scheduling algorithm over the generated corpus, generating
+ * any missing workloads first, and prints the results. Then either saves the
+ * results as the new baseline or compares them with the existing one. Returns
+ * the exit status: failure if any result regressed.
+ */
+int run_benchmarks(const BenchmarkOptions& options);
@@ -0,0 +1,23 @@
+#include "event_queues/binary_heap_event_queue.h"
+
+using namespace std;
+
+
+void BinaryHeapEventQueue::push(const Event& event) {
+  heap.push(event);
+}
+
+
+const Event& BinaryHeapEventQueue::top() {
+  return heap.top();
+}
+
+
+void BinaryHeapEventQueue::pop() {
+  heap.pop();
+}
+
+
+size_t BinaryHeapEventQueue::size() const {
+  return heap.size();
+}
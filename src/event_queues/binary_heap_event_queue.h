@@ -0,0 +1,29 @@
+#pragma once
+#include "event_queues/event_queue.h"
+#include "types/event.h"
+#include <queue>
+#include <vector>
+
+
+/**
+ * An event queue backed by a binary heap (std::priority_queue). Every push and
+ * pop costs O(log n).
+ */
+class BinaryHeapEventQueue : public EventQueue {
+public:
+
+  virtual void push(const Event& event) override;
+
+
+  virtual const Event& top() override;
+
+
+  virtual void pop() override;
+
+
+  virtual size_t size() const override;
+
+private:
+
+  std::priority_queue<Event, std::vector<Event>, EventComparator> heap;
+};
@@ -0,0 +1,180 @@
+#include "event_queues/calendar_event_queue.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+
+CalendarEventQueue::CalendarEventQueue()
+    : buckets(MIN_BUCKETS), num_buckets(MIN_BUCKETS) {}
+
+
+void CalendarEventQueue::push(const Event& event) {
+  // an event before the current day (or the first event of all) moves the
+  // calendar back so that it isn't skipped over
+  if (count == 0 || event.time < bucket_top - width) {
+    seek(event.time);
+  }
+
+  size_t node = free_list;
+  if (node == NONE) {
+    node = nodes.size();
+    nodes.emplace_back(event);
+  } else {
+    free_list = nodes[node].next;
+    nodes[node].event = event;
+  }
+  insert(node);
+  count++;
+
+  if (count > 2 * num_buckets) resize(2 * num_buckets);
+}
+
+
+const Event& CalendarEventQueue::top() {
+  assert(count > 0);
+  locate_earliest();
+  return front(buckets[current_bucket]);
+}
+
+
+void CalendarEventQueue::pop() {
+  assert(count > 0);
+  locate_earliest();
+
+  // unlink the earliest node and return it to the free list
+  Bucket& bucket = buckets[current_bucket];
+  size_t node = bucket.head;
+  bucket.head = nodes[node].next;
+  if (bucket.head == NONE) bucket.tail = NONE;
+  nodes[node].next = free_list;
+  free_list = node;
+  located = false;
+  count--;
+
+  if (count < num_buckets / 2 && num_buckets > MIN_BUCKETS) {
+    resize(num_buckets / 2);
+  }
+}
+
+
+size_t CalendarEventQueue::size() const {
+  return count;
+}
+
+
+size_t CalendarEventQueue::bucket_for(long long time) const {
+  // a negative time would hash to a negative index
+  assert(time >= 0);
+  return (size_t)((time / width) % (long long)num_buckets);
+}
+
+
+void CalendarEventQueue::insert(size_t node) {
+  const Event& event = nodes[node].event;
+  Bucket& bucket = buckets[bucket_for(event.time)];
+  EventComparator later;
+  // most events are scheduled after everything already in their bucket
+  if (bucket.empty() || later(event, nodes[bucket.tail].event)) {
+    nodes[node].next = NONE;
+    if (bucket.empty()) {
+      bucket.head = node;
+    } else {
+      nodes[bucket.tail].next = node;
+    }
+    bucket.tail = node;
+    return;
+  }
+  if (!later(event, front(bucket))) {
+    nodes[node].next = bucket.head;
+    bucket.head = node;
+    return;
+  }
+  size_t previous = bucket.head;
+  while (later(event, nodes[nodes[previous].next].event)) {
+    previous = nodes[previous].next;
+  }
+  nodes[node].next = nodes[previous].next;
+  nodes[previous].next = node;
+}
+
+
+void CalendarEventQueue::seek(long long time) {
+  current_bucket = bucket_for(time);
+  bucket_top = (time / width + 1) * width;
+  located = false;
+}
+
+
+void CalendarEventQueue::locate_earliest() {
+  if (located) return;
+
+  // walk through the days of the current year looking for an event that falls
+  // within its day
+  for (size_t n = 0; n < num_buckets; n++) {
+    const Bucket& bucket = buckets[current_bucket];
+    if (!bucket.empty() && front(bucket).time < bucket_top) {
+      located = true;
+      return;
+    }
+    current_bucket = (current_bucket + 1) % num_buckets;
+    bucket_top += width;
+  }
+
+  // the next event is more than a year away, so search for it directly
+  long long earliest = 0;
+  bool found = false;
+  for (size_t b = 0; b < num_buckets; b++) {
+    const Bucket& bucket = buckets[b];
+    if (!bucket.empty() && (!found || front(bucket).time < earliest)) {
+      earliest = front(bucket).time;
+      found = true;
+    }
+  }
+  assert(found);
+  seek(earliest);
+  located = true;
+}
+
+
+void CalendarEventQueue::resize(size_t new_size) {
+  // unlink every event so they can be redistributed
+  scratch_nodes.clear();
+  scratch_times.clear();
+  for (size_t b = 0; b < num_buckets; b++) {
+    for (size_t node = buckets[b].head; node != NONE; node = nodes[node].next) {
+      scratch_nodes.push_back(node);
+      scratch_times.push_back(nodes[node].event.time);
+    }
+    buckets[b] = Bucket();
+  }
+
+  // estimate the average separation between the events nearest the front of
+  // the queue, ignoring outliers, and make each day three times that long
+  vector<long long>& times = scratch_times;
+  size_t samples = min(times.size(), (size_t)25);
+  long long earliest = times.empty() ? 0 : *min_element(times.begin(), times.end());
+  if (samples > 1) {
+    nth_element(times.begin(), times.begin() + (samples - 1), times.end());
+    sort(times.begin(), times.begin() + samples);
+
+    double average = (double)(times[samples - 1] - times[0]) / (samples - 1);
+    long long total = 0;
+    size_t gaps = 0;
+    for (size_t i = 1; i < samples; i++) {
+      long long gap = times[i] - times[i - 1];
+      if (gap <= 2 * average) {
+        total += gap;
+        gaps++;
+      }
+    }
+    width = (gaps > 0 && total > 0) ? max(1LL, 3 * total / (long long)gaps) : 1;
+  }
+
+  if (new_size > buckets.size()) buckets.resize(new_size);
+  num_buckets = new_size;
+  for (size_t node : scratch_nodes) insert(node);
+
+  // reposition the calendar at the earliest event
+  if (!scratch_nodes.empty()) seek(earliest);
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "event_queues/event_queue.h"
+#include "types/event.h"
+#include <vector>
+
+
+/**
+ * An event queue that uses a calendar queue (R. Brown, 1988). Events are
+ * hashed by time into an array of buckets ("days"), each of which covers
+ * `width` ticks of a "year" that wraps around the array. Dequeuing walks the
+ * days in order, so with a well-chosen bucket width both push and pop take
+ * amortized O(1). The number of buckets and their width are re-tuned whenever
+ * the queue doubles or halves in size.
+ *
+ * The buckets are linked lists threaded through a single pool of nodes, so
+ * once the pool and bucket array have grown to the queue's peak size, neither
+ * pushing, popping nor re-tuning the calendar allocates memory.
+ */
+class CalendarEventQueue : public EventQueue {
+public:
+
+  CalendarEventQueue();
+
+
+  virtual void push(const Event& event) override;
+
+
+  virtual const Event& top() override;
+
+
+  virtual void pop() override;
+
+
+  virtual size_t size() const override;
+
+private:
+
+  /**
+   * Marks the end of a bucket's list or of the free list.
+   */
+  static const size_t NONE = (size_t)-1;
+
+  /**
+   * An event in the pool, linked to the next node of its bucket (or of the
+   * free list, if it is unused).
+   */
+  struct Node {
+    Event event;
+    size_t next = NONE;
+
+    Node(const Event& event) : event(event) {}
+  };
+
+  /**
+   * A single day of the calendar: a list of nodes kept sorted by time. The
+   * tail is tracked because most events are scheduled after everything
+   * already in their bucket.
+   */
+  struct Bucket {
+    size_t head = NONE;
+    size_t tail = NONE;
+
+    bool empty() const { return head == NONE; }
+  };
+
+  /**
+   * Returns the earliest event in the given (non-empty) bucket.
+   */
+  const Event& front(const Bucket& bucket) const {
+    return nodes[bucket.head].event;
+  }
+
+  /**
+   * Returns the index of the bucket that holds events at the given time.
+   */
+  size_t bucket_for(long long time) const;
+
+  /**
+   * Links a node into the correct bucket, keeping the bucket sorted by time
+   * and then sequence number.
+   */
+  void insert(size_t node);
+
+  /**
+   * Moves the calendar's position to the day containing the given time.
+   */
+  void seek(long long time);
+
+  /**
+   * Advances the calendar's position to the bucket holding the earliest event.
+   */
+  void locate_earliest();
+
+  /**
+   * Rebuilds the calendar with the given number of buckets, re-estimating the
+   * bucket width from the events closest to the front of the queue.
+   */
+  void resize(size_t new_size);
+
+  /**
+   * The smallest number of buckets the calendar will shrink to.
+   */
+  static const size_t MIN_BUCKETS = 16;
+
+  /**
+   * The days of the calendar. Only the first `num_buckets` are in use; the
+   * rest are kept from when the calendar was larger so it can grow back
+   * without allocating.
+   */
+  std::vector<Bucket> buckets;
+
+  /**
+   * The number of buckets in use.
+   */
+  size_t num_buckets;
+
+  /**
+   * Storage for every event in the queue, plus unused nodes on the free list.
+   */
+  std::vector<Node> nodes;
+
+  /**
+   * The first unused node in `nodes`.
+   */
+  size_t free_list = NONE;
+
+  /**
+   * Scratch space used while re-tuning the calendar, kept between resizes.
+   */
+  std::vector<size_t> scratch_nodes;
+  std::vector<long long> scratch_times;
+
+  /**
+   * The number of ticks covered by a single bucket.
+   */
+  long long width = 1;
+
+  /**
+   * The bucket that the calendar is currently positioned on.
+   */
+  size_t current_bucket = 0;
+
+  /**
+   * The exclusive upper bound on event times in the current bucket for the
+   * current year.
+   */
+  long long bucket_top = 1;
+
+  /**
+   * Whether `current_bucket` is known to hold the earliest event.
+   */
+  bool located = false;
+
+  /**
+   * The number of events in the queue.
+   */
+  size_t count = 0;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "types/event.h"
+#include <cstddef>
+
+
+/**
+ * Abstract base class for the set of pending events in the simulation. Events
+ * are stored by value and handed back in increasing order of time.
+ */
+struct EventQueue {
+  /**
+   * Adds a copy of the given event to the queue.
+   */
+  virtual void push(const Event& event) = 0;
+
+  /**
+   * Returns the earliest event in the queue. The queue must not be empty.
+   */
+  virtual const Event& top() = 0;
+
+  /**
+   * Removes the earliest event from the queue. The queue must not be empty.
+   */
+  virtual void pop() = 0;
+
+  /**
+   * Returns the number of events in the queue.
+   */
+  virtual size_t size() const = 0;
+
+  /**
+   * Returns true if there are no events left in the queue.
+   */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Virtual destructor (as a best practice).
+   */
+  virtual ~EventQueue() {}
+};
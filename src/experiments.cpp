@@ -0,0 +1,216 @@
+#include "experiments.h"
+#include "simulation.h"
+#include "util/thread_pool.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+void run_comparison(const Workload& workload, const FlagOptions& flags,
+                    const Logger& logger) {
+  vector<SystemStats> results(SCHEDULER_NAMES.size());
+
+  {
+    ThreadPool pool(SCHEDULER_NAMES.size());
+
+    // each simulation gets its own scheduler, event queue and thread state,
+    // and only reads from the shared workload
+    for (size_t i = 0; i < SCHEDULER_NAMES.size(); i++) {
+      pool.submit([&workload, &flags, &results, i] {
+        unique_ptr<Scheduler> scheduler(
+            instantiate_scheduler(SCHEDULER_NAMES[i], flags.scheduler));
+        unique_ptr<EventQueue> events(instantiate_event_queue(flags.event_queue));
+        unique_ptr<Simulation> simulation(instantiate_simulation(
+            scheduler.get(), events.get(), Logger(false, false, false)));
+        simulation->set_fast_forward(flags.fast_forward);
+        simulation->set_fused_dispatch(flags.fused_dispatch);
+        results[i] = simulation->simulate(workload);
+      });
+    }
+
+    pool.wait();
+  }
+
+  logger.print_comparison(SCHEDULER_NAMES, results);
+}
+
+
+/**
+ * The parameters of a single simulation in a sweep.
+ */
+struct SweepPoint {
+  string algorithm;
+  size_t quantum;
+  size_t thread_switch;
+  size_t process_switch;
+};
+
+
+/**
+ * Returns every combination of the swept parameters, starting from the
+ * algorithm(s) chosen on the command line and the workload's own overheads.
+ */
+static vector<SweepPoint> expand_sweep(const Workload& workload,
+                                       const FlagOptions& flags) {
+  vector<SweepPoint> points;
+  vector<string> algorithms = flags.compare
+      ? SCHEDULER_NAMES
+      : vector<string>(1, flags.algorithm);
+
+  for (const string& algorithm : algorithms) {
+    points.push_back({algorithm, DEFAULT_TIME_SLICE,
+                      workload.thread_switch_overhead,
+                      workload.process_switch_overhead});
+  }
+
+  // take the cartesian product with each range in turn
+  for (const SweepRange& range : flags.sweep) {
+    vector<SweepPoint> expanded;
+    for (const SweepPoint& point : points) {
+      for (size_t value = range.first; value <= range.last; value += range.step) {
+        SweepPoint next = point;
+        if (range.parameter == "quantum") {
+          next.quantum = value;
+        } else if (range.parameter == "thread_switch") {
+          next.thread_switch = value;
+        } else {
+          next.process_switch = value;
+        }
+        expanded.push_back(next);
+        // stop before the next step could wrap around past the end
+        if (range.last - value < range.step) break;
+      }
+    }
+    points.swap(expanded);
+  }
+
+  return points;
+}
+
+
+void run_sweep(const Workload& workload, const FlagOptions& flags,
+               const Logger& logger) {
+  vector<SweepPoint> points = expand_sweep(workload, flags);
+  vector<SystemStats> results(points.size());
+
+  {
+    ThreadPool pool;
+
+    for (size_t i = 0; i < points.size(); i++) {
+      pool.submit([&workload, &flags, &points, &results, i] {
+        const SweepPoint& point = points[i];
+        SchedulerOptions options = flags.scheduler;
+        options.time_slice = point.quantum;
+        unique_ptr<Scheduler> scheduler(
+            instantiate_scheduler(point.algorithm, options));
+        unique_ptr<EventQueue> events(instantiate_event_queue(flags.event_queue));
+        unique_ptr<Simulation> simulation(instantiate_simulation(
+            scheduler.get(), events.get(), Logger(false, false, false)));
+        simulation->set_switch_overheads(point.thread_switch, point.process_switch);
+        simulation->set_fast_forward(flags.fast_forward);
+        simulation->set_fused_dispatch(flags.fused_dispatch);
+        results[i] = simulation->simulate(workload);
+      });
+    }
+
+    pool.wait();
+  }
+
+  logger.print_csv_header({"algorithm", "quantum", "thread_switch",
+                           "process_switch"});
+  for (size_t i = 0; i < points.size(); i++) {
+    const SweepPoint& point = points[i];
+    logger.print_csv_row({point.algorithm, to_string(point.quantum),
+                          to_string(point.thread_switch),
+                          to_string(point.process_switch)},
+                         results[i]);
+  }
+}
+
+
+// returns whether two runs of the same thread ended up the same
+static bool same_thread(const Thread& a, const Thread& b) {
+  return a.arrival_time == b.arrival_time && a.start_time == b.start_time
+      && a.end_time == b.end_time && a.service_time == b.service_time
+      && a.io_time == b.io_time && a.current_state == b.current_state
+      && a.burst_index == b.burst_index;
+}
+
+
+// returns whether two runs produced the same statistics, down to the bit
+static bool same_statistics(const SystemStats& a, const SystemStats& b) {
+  bool same = a.total_time == b.total_time
+      && a.total_idle_time == b.total_idle_time
+      && a.dispatch_time == b.dispatch_time
+      && a.service_time == b.service_time
+      && a.io_time == b.io_time
+      && a.total_cpu_time == b.total_cpu_time
+      && a.cpu_utilization == b.cpu_utilization
+      && a.cpu_efficiency == b.cpu_efficiency;
+  for (int i = 0; i < 4; i++) {
+    same = same && a.thread_counts[i] == b.thread_counts[i]
+        && a.avg_thread_response_times[i] == b.avg_thread_response_times[i]
+        && a.avg_thread_turnaround_times[i] == b.avg_thread_turnaround_times[i];
+  }
+  return same;
+}
+
+
+bool verify_fast_forward(const Workload& workload, const FlagOptions& flags) {
+  // the first simulation handles every event, and the second skips what it
+  // can; both are kept until their threads have been compared
+  unique_ptr<Scheduler> schedulers[2];
+  unique_ptr<EventQueue> queues[2];
+  unique_ptr<Simulation> simulations[2];
+  SystemStats results[2];
+
+  {
+    ThreadPool pool(2);
+
+    for (int i = 0; i < 2; i++) {
+      schedulers[i].reset(
+          instantiate_scheduler(flags.algorithm, flags.scheduler));
+      queues[i].reset(instantiate_event_queue(flags.event_queue));
+      simulations[i].reset(instantiate_simulation(
+          schedulers[i].get(), queues[i].get(), Logger(false, false, false)));
+      simulations[i]->set_fast_forward(i == 1);
+      simulations[i]->set_fused_dispatch(flags.fused_dispatch);
+      pool.submit([&workload, &simulations, &results, i] {
+        results[i] = simulations[i]->simulate(workload);
+      });
+    }
+
+    pool.wait();
+  }
+
+  const vector<Thread>& stepped = simulations[0]->threads();
+  const vector<Thread>& skipped = simulations[1]->threads();
+  size_t mismatched = 0;
+  for (size_t i = 0; i < stepped.size(); i++) {
+    if (!same_thread(stepped[i], skipped[i])) {
+      if (mismatched == 0) {
+        cerr << "Thread " << stepped[i].id << " of process " << stepped[i].pid
+             << " differs when fast-forwarded" << endl;
+      }
+      mismatched++;
+    }
+  }
+
+  bool same_results = same_statistics(results[0], results[1]);
+  if (mismatched > 0 || !same_results) {
+    cerr << "Fast-forwarding differs from step-by-step simulation: "
+         << mismatched << " of " << stepped.size() << " threads and "
+         << (same_results ? "none" : "some") << " of the statistics differ"
+         << endl;
+    return false;
+  }
+
+  cout << "Fast-forwarding matches step-by-step simulation for "
+       << stepped.size() << " threads, skipping "
+       << simulations[1]->engine_statistics().skipped_events << " of "
+       << simulations[0]->engine_statistics().num_events << " events" << endl;
+  return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "types/workload.h"
+#include "util/flags.h"
+#include "util/logger.h"
+
+
+/**
+ * Simulates the workload once with every scheduling algorithm, running the
+ * simulations in parallel, and prints their statistics side by side.
+ */
+void run_comparison(const Workload& workload, const FlagOptions& flags,
+                    const Logger& logger);
+
+
+/**
+ * Simulates every combination of the swept parameters over the workload,
+ * running the simulations in parallel, and prints one CSV row per
+ * combination.
+ */
+void run_sweep(const Workload& workload, const FlagOptions& flags,
+               const Logger& logger);
+
+
+/**
+ * Simulates the workload with the chosen algorithm twice, once handling
+ * every event and once fast-forwarding, and reports whether every statistic
+ * and every thread came out the same. Returns true if they did.
+ */
+bool verify_fast_forward(const Workload& workload, const FlagOptions& flags);
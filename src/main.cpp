@@ -1,22 +1,181 @@
+#include "benchmark.h"
+#include "experiments.h"
+#include "microbenchmark.h"
 #include "simulation.h"
+#include "trace_export.h"
+#include "types/workload.h"
+#include "util/binary_workload.h"
 #include "util/flags.h"
 #include "util/logger.h"
+#include "util/workload_reader.h"
+#include <chrono>
 #include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sys/stat.h>
 #include <string>
 
 using namespace std;
 
 
+// Parses a text simulation file with the parser chosen on the command line.
+static Workload parse_text_workload(const FlagOptions& flags) {
+  unique_ptr<Tokenizer> tokens(
+      instantiate_tokenizer(flags.parser, flags.filename));
+  return read_workload(*tokens);
+}
+
+
+// Loads the simulation file, which may be text or binary. With --cache, a
+// text file is loaded from its binary conversion when that conversion was
+// made from identical contents, and converted otherwise.
+static Workload load_workload(const FlagOptions& flags) {
+  MappedFile input(flags.filename);
+  if (!input.is_open()) {
+    cerr << "Unable to open simulation file: " << flags.filename << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (is_binary_workload(input)) {
+    return read_binary_workload(input, flags.filename);
+  }
+
+  if (!flags.cache) {
+    return parse_text_workload(flags);
+  }
+
+  uint64_t input_hash = hash_bytes(input.data(), input.size());
+  string cache_name = flags.filename + ".simbin";
+  MappedFile cache(cache_name);
+  uint64_t cached_hash;
+  if (cache.is_open() && read_binary_source_hash(cache, cached_hash)
+      && cached_hash == input_hash) {
+    return read_binary_workload(cache, cache_name);
+  }
+
+  Workload workload = parse_text_workload(flags);
+  if (!write_binary_workload(cache_name, workload, input_hash)) {
+    cerr << "Unable to write cache file: " << cache_name << endl;
+  }
+  return workload;
+}
+
+
+// Creates the trace file requested with --trace, or returns NULL.
+static EventTraceWriter* open_trace(const FlagOptions& flags) {
+  return flags.trace.empty() ? nullptr : new EventTraceWriter(flags.trace);
+}
+
+
 // Entry point to the simulation.
 int main(int argc, char** argv) {
+  if (argc > 1 && string(argv[1]) == "bench") {
+    return run_benchmarks(parse_benchmark_flags(argc - 1, argv + 1));
+  }
+
+  if (argc > 1 && string(argv[1]) == "microbench") {
+    run_microbenchmarks(parse_microbenchmark_flags(argc - 1, argv + 1));
+    return EXIT_SUCCESS;
+  }
+
+  if (argc > 1 && string(argv[1]) == "export") {
+    export_trace(parse_export_flags(argc - 1, argv + 1));
+    return EXIT_SUCCESS;
+  }
+
+  if (argc > 1 && string(argv[1]) == "generate") {
+    generate_workload(parse_generator_flags(argc - 1, argv + 1));
+    return EXIT_SUCCESS;
+  }
+
   FlagOptions flags = parse_flags(argc, argv);
-  Logger logger(flags.verbose, flags.detailed);
+  Logger logger(flags.verbose, flags.detailed, flags.engine_stats);
+
+  if (flags.convert) {
+    MappedFile input(flags.filename);
+    if (!input.is_open()) {
+      cerr << "Unable to open simulation file: " << flags.filename << endl;
+      exit(EXIT_FAILURE);
+    }
+    if (is_binary_workload(input)) {
+      cerr << flags.filename << " is already a binary workload" << endl;
+      exit(EXIT_FAILURE);
+    }
+
+    Workload workload = parse_text_workload(flags);
+    if (!write_binary_workload(flags.output, workload,
+                               hash_bytes(input.data(), input.size()))) {
+      cerr << "Unable to write binary workload: " << flags.output << endl;
+      exit(EXIT_FAILURE);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (flags.stream) {
+    if (is_binary_workload(MappedFile(flags.filename))) {
+      cerr << "--stream requires a text simulation file" << endl;
+      exit(EXIT_FAILURE);
+    }
+
+    unique_ptr<Tokenizer> tokens(
+        instantiate_tokenizer(flags.parser, flags.filename));
+    unique_ptr<WorkloadStream> workload(flags.background_parse
+        ? new BackgroundWorkloadStream(*tokens)
+        : new WorkloadStream(*tokens));
+    unique_ptr<Scheduler> scheduler(
+        instantiate_scheduler(flags.algorithm, flags.scheduler));
+    unique_ptr<EventQueue> events(instantiate_event_queue(flags.event_queue));
+    unique_ptr<EventTraceWriter> trace(open_trace(flags));
+    unique_ptr<Simulation> simulation(
+        instantiate_simulation(scheduler.get(), events.get(), logger));
+    simulation->set_trace(trace.get());
+    simulation->set_fast_forward(flags.fast_forward);
+    simulation->set_fused_dispatch(flags.fused_dispatch);
+
+    // Execute the simulation as the file is read.
+    simulation->run(*workload);
+    return EXIT_SUCCESS;
+  }
+
+  // Parse the provided file once; the workload is never modified.
+  chrono::steady_clock::time_point parse_start = chrono::steady_clock::now();
+  Workload workload = load_workload(flags);
+  chrono::duration<double> parse_time = chrono::steady_clock::now() - parse_start;
+
+  if (flags.parse_only) {
+    struct stat info;
+    size_t bytes = (stat(flags.filename.c_str(), &info) == 0) ? info.st_size : 0;
+    logger.print_parse_stats(workload, bytes, parse_time.count());
+    return EXIT_SUCCESS;
+  }
+
+  if (!flags.sweep.empty()) {
+    run_sweep(workload, flags, logger);
+    return EXIT_SUCCESS;
+  }
+
+  if (flags.compare) {
+    run_comparison(workload, flags, logger);
+    return EXIT_SUCCESS;
+  }
+
+  if (flags.verify_fast_forward) {
+    return verify_fast_forward(workload, flags) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
 
   // Create the simulation.
-  Simulation simulation(flags.scheduler, logger);
+  unique_ptr<Scheduler> scheduler(
+      instantiate_scheduler(flags.algorithm, flags.scheduler));
+  unique_ptr<EventQueue> events(instantiate_event_queue(flags.event_queue));
+  unique_ptr<EventTraceWriter> trace(open_trace(flags));
+  unique_ptr<Simulation> simulation(
+      instantiate_simulation(scheduler.get(), events.get(), logger));
+  simulation->set_trace(trace.get());
+  simulation->set_fast_forward(flags.fast_forward);
+  simulation->set_fused_dispatch(flags.fused_dispatch);
 
-  // Execute the simulation on the provided file.
-  simulation.run(flags.filename);
+  // Execute the simulation on the workload.
+  simulation->run(workload);
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,177 @@
+#include "microbenchmark.h"
+#include "types/event.h"
+#include "types/process.h"
+#include "util/allocation_counter.h"
+#include "util/logger.h"
+#include "util/object_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+
+/**
+ * The most operations that are timed as one interval. Shallow queues use one
+ * interval per full pass over the queue.
+ */
+static const size_t MAX_BATCH = 1024;
+
+
+/**
+ * Accumulates the time and allocations of one kind of operation.
+ */
+struct OperationCost {
+  double nanoseconds = 0;
+  size_t allocations = 0;
+  size_t operations = 0;
+
+  /**
+   * Runs `batch` as one timed interval of `count` operations. The cost of
+   * reading the clock is subtracted so that single-operation intervals at
+   * depth 1 are not dominated by it.
+   */
+  template <typename Batch>
+  void measure(size_t count, double clock_overhead, Batch batch) {
+    size_t allocations_before = allocation_count();
+    Clock::time_point start = Clock::now();
+    batch();
+    Clock::time_point end = Clock::now();
+    allocations += allocation_count() - allocations_before;
+
+    double elapsed = chrono::duration<double, nano>(end - start).count();
+    nanoseconds += max(0.0, elapsed - clock_overhead);
+    operations += count;
+  }
+
+  double ns_per_op() const {
+    return operations ? nanoseconds / operations : 0;
+  }
+
+  double allocations_per_op() const {
+    return operations ? (double) allocations / operations : 0;
+  }
+};
+
+
+// returns the time taken by an empty interval, in nanoseconds
+static double measure_clock_overhead() {
+  const int samples = 10000;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < samples; i++) {
+    Clock::time_point a = Clock::now();
+    Clock::time_point b = Clock::now();
+    (void) (b - a);
+  }
+  Clock::time_point end = Clock::now();
+  return chrono::duration<double, nano>(end - start).count() / samples / 2;
+}
+
+
+// Fills the scheduler to the given depth, then repeatedly takes a batch of
+// threads out and puts them back, and preempts threads one at a time, until
+// each kind of operation has been timed `num_operations` times.
+static void benchmark_depth(const string& algorithm, size_t depth,
+                            size_t num_operations, double clock_overhead,
+                            vector<Thread>& threads,
+                            const Logger& logger) {
+  ObjectPool<SchedulingDecision> decisions;
+  unique_ptr<Scheduler> scheduler(instantiate_scheduler(algorithm));
+  scheduler->set_decision_pool(&decisions);
+  scheduler->set_thread_table(&threads);
+
+  Event event(Event::THREAD_PREEMPTED, 0, NO_THREAD);
+  for (size_t i = 0; i < depth; i++) {
+    // the previous depth's scheduler was dropped with threads still linked
+    threads[i].queue_level = -1;
+    threads[i].ready_prev = NO_THREAD;
+    threads[i].ready_next = NO_THREAD;
+    scheduler->enqueue(&event, &threads[i]);
+  }
+
+  size_t batch_size = min(depth, MAX_BATCH);
+  vector<ThreadIndex> batch(batch_size);
+  OperationCost enqueue, dequeue, preempt, size, warm_up;
+  volatile size_t sink = 0;
+
+  // the first round warms up the decision pool and the queues' storage, and
+  // is not counted
+  for (size_t round = 0; dequeue.operations < num_operations; round++) {
+    OperationCost& dequeue_cost = round ? dequeue : warm_up;
+    OperationCost& enqueue_cost = round ? enqueue : warm_up;
+
+    dequeue_cost.measure(batch_size, clock_overhead, [&] {
+      for (size_t i = 0; i < batch_size; i++) {
+        SchedulingDecision* decision = scheduler->get_next_thread(&event);
+        batch[i] = decision->thread;
+        decisions.release(decision);
+      }
+    });
+
+    enqueue_cost.measure(batch_size, clock_overhead, [&] {
+      for (size_t i = 0; i < batch_size; i++) {
+        scheduler->enqueue(&event, &threads[batch[i]]);
+      }
+    });
+  }
+
+  // a preemption takes the next thread and puts it straight back
+  while (preempt.operations < num_operations) {
+    preempt.measure(batch_size, clock_overhead, [&] {
+      for (size_t i = 0; i < batch_size; i++) {
+        SchedulingDecision* decision = scheduler->get_next_thread(&event);
+        scheduler->enqueue(&event, &threads[decision->thread]);
+        decisions.release(decision);
+      }
+    });
+  }
+
+  while (size.operations < num_operations) {
+    size.measure(batch_size, clock_overhead, [&] {
+      for (size_t i = 0; i < batch_size; i++) {
+        sink = sink + scheduler->size();
+      }
+    });
+  }
+
+  logger.print_microbenchmark_row(algorithm, depth,
+      enqueue.ns_per_op(), dequeue.ns_per_op(), preempt.ns_per_op(),
+      size.ns_per_op(), enqueue.allocations_per_op(),
+      dequeue.allocations_per_op());
+}
+
+
+void run_microbenchmarks(const MicrobenchmarkOptions& options) {
+  // one process of each type, with threads spread evenly across them
+  vector<unique_ptr<Process>> processes;
+  for (int type = Process::SYSTEM; type <= Process::BATCH; type++) {
+    processes.emplace_back(new Process(type, (Process::Type) type));
+  }
+
+  vector<Thread> threads;
+  threads.reserve(options.max_depth);
+  for (size_t i = 0; i < options.max_depth; i++) {
+    size_t process = i % processes.size();
+    threads.emplace_back(0, i, *processes[process], process);
+    threads.back().index = i;
+    // spread the bursts out, for the schedulers that order threads by them
+    threads.back().remaining_burst = 1 + (i * 7919) % 1000;
+  }
+
+  double clock_overhead = measure_clock_overhead();
+  Logger logger(false, false, false);
+  logger.print_microbenchmark_header();
+
+  for (const string& algorithm : SCHEDULER_NAMES) {
+    if (options.algorithm != "" && options.algorithm != algorithm) continue;
+
+    for (size_t depth = 1; depth <= options.max_depth; depth *= 10) {
+      benchmark_depth(algorithm, depth, options.operations, clock_overhead,
+                      threads, logger);
+    }
+  }
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "util/flags.h"
+
+
+/**
+ * Drives every scheduler through synthetic enqueue, dequeue and preempt
+ * patterns at ready-queue depths from 1 up to the configured maximum, apart
+ * from the event engine, and prints the cost of each operation.
+ */
+void run_microbenchmarks(const MicrobenchmarkOptions& options);
@@ -1,78 +1,167 @@
 #include "simulation.h"
+#include "algorithms/cfs_scheduler.h"
+#include "algorithms/fcfs_scheduler.h"
+#include "algorithms/multilevel_feedback_scheduler.h"
+#include "algorithms/priority_scheduler.h"
+#include "algorithms/round_robin_scheduler.h"
+#include "algorithms/spn_scheduler.h"
+#include "algorithms/srtf_scheduler.h"
 #include "types/event.h"
+#include "util/allocation_counter.h"
+#include <algorithm>
 #include <cassert>
-#include <fstream>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <sys/resource.h>
 
 using namespace std;
 
 
-void Simulation::run(const string& filename) {
-  read_file(filename);
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::run(const Workload& workload) {
+  SystemStats results = simulate(workload);
 
-  // While their are still events to process, invoke the corresponding methods
-  // to handle them.
-  while (!events.empty()) {
-    const Event* event = events.top();
-    events.pop();
+  // processes are listed by PID, whatever order the workload had them in
+  vector<const Process*> by_pid;
+  for (const Process& process : run_state->processes) {
+    by_pid.push_back(&process);
+  }
+  stable_sort(by_pid.begin(), by_pid.end(),
+              [](const Process* a, const Process* b) { return a->pid < b->pid; });
 
-    // Invoke the appropriate method on the scheduler for the given event type.
-    switch (event->type) {
-    case Event::THREAD_ARRIVED:
-      handle_thread_arrived(event);
-      break;
+  for (const Process* process : by_pid) {
+    logger.print_process_details(*process, run_state->threads);
+  }
 
-    case Event::THREAD_DISPATCH_COMPLETED:
-      handle_thread_dispatch_completed(event);
-      break;
+  logger.print_statistics(results);
+  logger.print_scheduler_metrics(scheduler->metrics());
+  logger.print_engine_stats(engine_stats);
+}
 
-    case Event::PROCESS_DISPATCH_COMPLETED:
-      handle_process_dispatch_completed(event);
-      break;
 
-    case Event::CPU_BURST_COMPLETED:
-      handle_cpu_burst_completed(event);
-      break;
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::run(WorkloadStream& workload) {
+  // threads are freed as they exit, so there are no per-thread details to show
+  logger.print_statistics(simulate(workload));
+  logger.print_scheduler_metrics(scheduler->metrics());
+  logger.print_engine_stats(engine_stats);
+}
 
-    case Event::IO_BURST_COMPLETED:
-      handle_io_burst_completed(event);
-      break;
 
-    case Event::THREAD_COMPLETED:
-      handle_thread_completed(event);
-      break;
+template <typename SchedulerT>
+SystemStats SimulationEngine<SchedulerT>::simulate(const Workload& workload) {
+  load(workload);
+  process_events();
+  return calculate_statistics();
+}
 
-    case Event::THREAD_PREEMPTED:
-      handle_thread_preempted(event);
-      break;
 
-    case Event::DISPATCHER_INVOKED:
-      handle_dispatcher_invoked(event);
-      break;
-    }
+template <typename SchedulerT>
+SystemStats SimulationEngine<SchedulerT>::simulate(WorkloadStream& workload) {
+  if (!overheads_overridden) {
+    thread_switch_overhead = workload.thread_switch_overhead;
+    process_switch_overhead = workload.process_switch_overhead;
+  }
+
+  run_state.reset(new RunState());
+  scheduler->set_thread_table(&run_state->threads);
+  begin_run();
+
+  stream = &workload;
+  has_lookahead = stream->next(lookahead);
+  process_events();
+  stream = nullptr;
+
+  return calculate_statistics();
+}
+
+
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::process_events() {
+  size_t allocations_before = allocation_count();
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
 
-    // change some of the stats in SystemStats
-    stats.total_time = event->time;
+  // While their are still events to process, handle every event that shares
+  // the earliest timestamp as one batch.
+  while (true) {
+    feed_arrivals();
+    if (events->empty()) break;
 
-    // print out for verbose output
-    // output on a non-null event that changed state
-    if (event->thread) {
-      if (event->thread->current_state != event->thread->previous_state) {
-        logger.print_state_transition(event,
-                                      event->thread->previous_state,
-                                      event->thread->current_state);
+    int batch_time = events->top().time;
+
+    while (!events->empty() && events->top().time == batch_time) {
+      const Event event = events->top();
+      events->pop();
+
+      // the end of a run that was cut short never happens
+      if ((event.type == Event::CPU_BURST_COMPLETED
+           || event.type == Event::THREAD_PREEMPTED)
+          && event.sequence != run_end_sequence) {
+        decisions.release(event.scheduling_decision);
+        engine_stats.cancelled_events++;
+        continue;
+      }
+
+      handle_event(&event);
+    }
+
+    // the dispatcher runs once at the end of the batch, no matter how many
+    // events in it asked for it
+    if (dispatcher_requested) {
+      dispatcher_requested = false;
+      if (active_thread == NO_THREAD) {
+        Event dispatch(Event::Type::DISPATCHER_INVOKED, batch_time, NO_THREAD);
+        if (fused_dispatch) {
+          // The batch has emptied the queue of events at this time, and no
+          // streamed thread arrives this early, so the queued event would
+          // have been the next one out anyway. Handle it right away instead.
+          dispatch.sequence = next_sequence++;
+          handle_event(&dispatch);
+          engine_stats.fused_events++;
+        } else {
+          add_event(dispatch);
+        }
       }
     }
+  }
+
+  // the trace must be out before the results are printed
+  logger.flush();
+
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  engine_stats.seconds = elapsed.count();
+  if (engine_stats.seconds > 0) {
+    engine_stats.events_per_second = engine_stats.num_events / engine_stats.seconds;
+  }
+
+  if (engine_stats.num_dispatches > 0) {
+    engine_stats.queued_events_per_dispatch =
+        (double)(engine_stats.num_events - engine_stats.fused_events)
+        / (double)engine_stats.num_dispatches;
+  }
 
-    // Free the event's memory.
-    delete event;
+  engine_stats.num_allocations = allocation_count() - allocations_before;
+  engine_stats.decision_slabs = decisions.slab_count();
+  if (engine_stats.num_events > 0) {
+    engine_stats.allocations_per_event =
+        (double)engine_stats.num_allocations / (double)engine_stats.num_events;
   }
 
-  for (pair<int, Process*> entry : processes) {
-    logger.print_process_details(entry.second);
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    engine_stats.peak_rss_kb = usage.ru_maxrss;
   }
+}
+
 
-  logger.print_statistics(calculate_statistics());
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::set_switch_overheads(size_t thread_switch, size_t process_switch) {
+  thread_switch_overhead = thread_switch;
+  process_switch_overhead = process_switch;
+  overheads_overridden = true;
 }
 
 
@@ -81,174 +170,366 @@ void Simulation::run(const string& filename) {
 //==============================================================================
 
 
-void Simulation::handle_thread_arrived(const Event* event) {
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_event(const Event* event) {
+  // the table does not change size while an event is handled, so the thread
+  // can be looked up once
+  Thread* thread = (event->thread == NO_THREAD)
+      ? nullptr : &run_state->threads[event->thread];
+
+  // the trace records the state the thread was in before the handler ran
+  Thread::State old_state = Thread::State::NEW;
+  bool traced = trace != nullptr && thread != nullptr;
+  if (traced) old_state = thread->current_state;
+
+  // Invoke the appropriate method on the scheduler for the given event type.
+  switch (event->type) {
+  case Event::THREAD_ARRIVED:
+    handle_thread_arrived(event, thread);
+    break;
+
+  case Event::THREAD_DISPATCH_COMPLETED:
+    handle_thread_dispatch_completed(event, thread);
+    break;
+
+  case Event::PROCESS_DISPATCH_COMPLETED:
+    handle_process_dispatch_completed(event, thread);
+    break;
+
+  case Event::CPU_BURST_COMPLETED:
+    handle_cpu_burst_completed(event, thread);
+    break;
+
+  case Event::IO_BURST_COMPLETED:
+    handle_io_burst_completed(event, thread);
+    break;
+
+  case Event::THREAD_COMPLETED:
+    handle_thread_completed(event, thread);
+    break;
+
+  case Event::THREAD_PREEMPTED:
+    handle_thread_preempted(event, thread);
+    break;
+
+  case Event::DISPATCHER_INVOKED:
+    handle_dispatcher_invoked(event);
+    break;
+  }
+
+  // change some of the stats in SystemStats
+  stats.total_time = event->time;
+
+  if (traced) {
+    trace_event(event, thread, old_state, thread->current_state);
+  }
+
+  // print out for verbose output
+  // output on a non-null event that changed state
+  if (thread) {
+    if (thread->current_state != thread->previous_state) {
+      logger.print_state_transition(event, thread,
+                                    thread->previous_state,
+                                    thread->current_state);
+    }
+
+    // when streaming, threads are freed as soon as they have exited
+    if (stream != nullptr && thread->current_state == Thread::State::EXIT) {
+      run_state->remove_thread(thread->index);
+    }
+  }
+
+  engine_stats.num_events++;
+
+  // the thread that has just become ready may take the CPU, which is done
+  // once this event has been logged so that the output stays in order
+  if (preemption_requested) {
+    preemption_requested = false;
+    preempt_if_needed(event);
+  }
+}
+
+
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::trace_event(const Event* event, const Thread* thread,
+                             Thread::State old_state, Thread::State new_state) {
+  TraceRecord record;
+  record.time = event->time;
+  record.type = event->type;
+  record.old_state = thread ? old_state : TraceRecord::NONE;
+  record.new_state = thread ? new_state : TraceRecord::NONE;
+  record.level = TraceRecord::NONE;
+  record.thread.pid = thread ? thread->pid : -1;
+  record.thread.tid = thread ? thread->id : -1;
+  trace->record(record);
+}
+
+
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::trace_decision(const Event* event,
+                                const SchedulingDecision* decision) {
+  const Thread* thread = &run_state->threads[decision->thread];
+  const Explanation& explanation = decision->explanation;
+
+  TraceRecord record;
+  record.time = event->time;
+  record.type = event->type;
+  record.old_state = thread->current_state;
+  record.new_state = thread->current_state;
+  record.level = (explanation.kind == Explanation::PRIORITY_QUEUE
+                  || explanation.kind == Explanation::FEEDBACK_LEVEL)
+      ? explanation.level : TraceRecord::NONE;
+  record.thread.pid = thread->pid;
+  record.thread.tid = thread->id;
+  trace->record(record);
+
+  record.type = TraceRecord::DECISION;
+  record.old_state = TraceRecord::NONE;
+  record.new_state = TraceRecord::NONE;
+  record.level = TraceRecord::NONE;
+  record.decision.time_slice = (int32_t) decision->time_slice;
+  record.decision.candidates = explanation.candidates;
+  trace->record(record);
+}
+
+
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_thread_arrived(const Event* event, Thread* thread) {
   // this is probably handled correctly (done in class)
-  assert(event->thread->current_state == Thread::State::NEW);
+  assert(thread->current_state == Thread::State::NEW);
   // set the thread state to ready
-  event->thread->set_state(Thread::State::READY, event->time);
-  assert(event->thread->current_state == Thread::State::READY);
+  thread->set_state(Thread::State::READY, event->time);
+  assert(thread->current_state == Thread::State::READY);
 
   // add the thread to the queue
-  scheduler->enqueue(event, event->thread);
+  scheduler->enqueue(event, thread);
+  preemption_requested = true;
 
   // create a new event to put on the queue
   invoke_dispatcher(event->time);
 }
 
 
-void Simulation::handle_thread_dispatch_completed(const Event* event) {
-  assert(event->thread->current_state == Thread::State::READY);
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_thread_dispatch_completed(const Event* event, Thread* thread) {
+  assert(thread->current_state == Thread::State::READY);
   // set the thread running
-  event->thread->set_state(Thread::State::RUNNING, event->time);
+  thread->set_state(Thread::State::RUNNING, event->time);
   // update the previously running thread
-  prev_thread = active_thread;
-  active_thread = event->thread;
+  prev_pid = thread->pid;
+  active_thread = thread->index;
 
   // create a new event based on the time slice and thread length
-  assert(event->thread->bursts.front()->type == Burst::Type::CPU);
-  size_t burst_length = event->thread->bursts.front()->length;
-  // make a copy of the scheduling decision since the old one will be deleted
-  SchedulingDecision* dec = new SchedulingDecision();
-  dec->thread = event->scheduling_decision->thread;
-  dec->time_slice = event->scheduling_decision->time_slice;
-  dec->explanation = event->scheduling_decision->explanation;
+  assert(thread->in_cpu_burst());
+  size_t burst_length = thread->remaining_burst;
+  // the scheduling decision is handed on to the preemption event, or returned
+  // to the pool if the thread will finish its burst first
+  const SchedulingDecision* dec = event->scheduling_decision;
   size_t time_slice = dec->time_slice;
+  size_t now = event->time;
+
+  // skip the turns the thread would spend alone on the CPU
+  if (skipping && time_slice < burst_length) {
+    now = fast_forward(event, thread, time_slice);
+    burst_length = thread->remaining_burst;
+  }
 
   if (time_slice < burst_length) { // thread gets preempted
-    Event* e = new Event(Event::Type::THREAD_PREEMPTED,
-                         event->time + time_slice,
-                         event->thread,
-                         dec);
-    add_event(e);
+    run_end_time = now + time_slice;
+    add_event(Event(Event::Type::THREAD_PREEMPTED,
+                    run_end_time,
+                    thread->index,
+                    dec));
     stats.service_time += time_slice;
   } else {
-    Event* e = new Event(Event::Type::CPU_BURST_COMPLETED,
-                         event->time + burst_length,
-                         event->thread);
-    add_event(e);
+    decisions.release(dec);
+    run_end_time = now + burst_length;
+    add_event(Event(Event::Type::CPU_BURST_COMPLETED,
+                    run_end_time,
+                    thread->index));
     stats.service_time += burst_length;
   }
+  // the event just added ends this run, unless the run is cut short
+  run_end_sequence = next_sequence - 1;
+
+  // a thread that became ready during the dispatch may take over right away
+  if (recheck_after_dispatch) {
+    recheck_after_dispatch = false;
+    preemption_requested = true;
+  }
 }
 
 
-void Simulation::handle_process_dispatch_completed(const Event* event) {
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_process_dispatch_completed(const Event* event, Thread* thread) {
   // a process dispatch does the same thing as a thread dispatch, so we call
   // that function here. This function is still used in order for the
   // output to work correctly.
-  handle_thread_dispatch_completed(event);
+  handle_thread_dispatch_completed(event, thread);
 }
 
 
-void Simulation::handle_cpu_burst_completed(const Event* event) {
-  // pop burst from queue
-  assert(event->thread->bursts.front()->type == Burst::Type::CPU);
-  event->thread->bursts.pop();
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_cpu_burst_completed(const Event* event, Thread* thread) {
+  // move on past the CPU burst
+  assert(thread->in_cpu_burst());
+  thread->finish_burst();
   // unset current_thread
-  prev_thread = active_thread;
-  active_thread = nullptr;
+  prev_pid = thread->pid;
+  active_thread = NO_THREAD;
 
   // invoke the dispatcher
   invoke_dispatcher(event->time);
 
   // add new event based on if this is the last CPU burst
-  Event* e;
-  if (event->thread->bursts.size() == 0) { // last CPU burst
-    e = new Event(Event::Type::THREAD_COMPLETED, event->time, event->thread);
+  if (thread->burst_index == thread->num_bursts) { // last CPU burst
+    add_event(Event(Event::Type::THREAD_COMPLETED, event->time, thread->index));
   } else {
-    event->thread->set_state(Thread::State::BLOCKED, event->time);
-    e = new Event(Event::Type::IO_BURST_COMPLETED,
-                  event->time + event->thread->bursts.front()->length,
-                  event->thread);
+    thread->set_state(Thread::State::BLOCKED, event->time);
+    add_event(Event(Event::Type::IO_BURST_COMPLETED,
+                    event->time + thread->remaining_burst,
+                    thread->index));
   }
-  add_event(e);
 }
 
 
-void Simulation::handle_io_burst_completed(const Event* event) {
-  assert(event->thread->current_state == Thread::State::BLOCKED);
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_io_burst_completed(const Event* event, Thread* thread) {
+  assert(thread->current_state == Thread::State::BLOCKED);
   // set corresponding thread to ready
-  event->thread->set_state(Thread::State::READY, event->time);
+  thread->set_state(Thread::State::READY, event->time);
 
-  // pop the io burst
-  assert(event->thread->bursts.front()->type == Burst::Type::IO);
+  // move on past the io burst
+  assert(!thread->in_cpu_burst());
   // change the system stats first
-  stats.io_time += event->thread->bursts.front()->length;
-  event->thread->bursts.pop();
+  stats.io_time += thread->remaining_burst;
+  thread->finish_burst();
 
   // enqueue the thread in the scheduler
-  scheduler->enqueue(event, event->thread);
+  scheduler->enqueue(event, thread);
+  preemption_requested = true;
 
   // invoke the dispatcher
   invoke_dispatcher(event->time);
 }
 
 
-void Simulation::handle_thread_completed(const Event* event) {
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_thread_completed(const Event* event, Thread* thread) {
   // set the thread state to exit
-  assert(event->thread->current_state == Thread::State::RUNNING);
-  event->thread->set_state(Thread::State::EXIT, event->time);
+  assert(thread->current_state == Thread::State::RUNNING);
+  thread->set_state(Thread::State::EXIT, event->time);
+
+  // fold the thread's times into the per-type totals
+  Process::Type type = thread->type;
+  stats.thread_counts[type]++;
+  stats.avg_thread_response_times[type] += thread->response_time();
+  stats.avg_thread_turnaround_times[type] += thread->turnaround_time();
   // the dispatcher has already been invoked by this time (in handle_cpu_burst_completed), there is
   // no need to call it again
 }
 
 
-void Simulation::handle_thread_preempted(const Event* event) {
-  // set the thread to ready
-  assert(event->thread->current_state == Thread::State::RUNNING);
-  event->thread->set_state(Thread::State::READY, event->time);
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_thread_preempted(const Event* event, Thread* thread) {
+  // decrease cpu burst by the time the thread ran, which is its whole time
+  // slice unless a thread that became ready cut it short, and take back the
+  // service time that was counted for the part it did not run
+  assert(thread->current_state == Thread::State::RUNNING);
+  assert(thread->in_cpu_burst());
+  size_t ran = event->time - thread->state_change_time;
+  assert(thread->remaining_burst > ran);
+  thread->remaining_burst -= ran;
+  stats.service_time -= run_end_time - event->time;
+  decisions.release(event->scheduling_decision);
 
-  // decrease cpu burst
-  assert(event->thread->bursts.front()->type == Burst::Type::CPU);
-  assert((size_t)event->thread->bursts.front()->length > event->scheduling_decision->time_slice);
-  event->thread->bursts.front()->length -= event->scheduling_decision->time_slice;
+  // set the thread to ready
+  thread->set_state(Thread::State::READY, event->time);
 
   // enqueue the thread in the scheduler
-  scheduler->enqueue(event, event->thread);
+  scheduler->enqueue(event, thread);
 
-  prev_thread = active_thread;
-  active_thread = nullptr;
+  prev_pid = thread->pid;
+  active_thread = NO_THREAD;
   invoke_dispatcher(event->time);
 }
 
 
-void Simulation::handle_dispatcher_invoked(const Event* event) {
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::handle_dispatcher_invoked(const Event* event) {
   // get current desicion and set the current thread
   SchedulingDecision* dec = scheduler->get_next_thread(event);
   // check for decision
-  if (dec == nullptr) return;
-  Thread* next_thread = dec->thread;
-  // check for next thread
-  if (next_thread == nullptr) return;
-  Event* e;
-  if (prev_thread == nullptr || next_thread->process != prev_thread->process) { // process switch
-    e = new Event(Event::Type::PROCESS_DISPATCH_COMPLETED,
-                 event->time + process_switch_overhead,
-                 next_thread,
-                 dec);
+  if (dec == nullptr || dec->thread == NO_THREAD) {
+    if (trace) {
+      trace_event(event, nullptr, Thread::State::NEW, Thread::State::NEW);
+    }
+    decisions.release(dec);
+    return;
+  }
+  Thread* next_thread = &run_state->threads[dec->thread];
+  engine_stats.num_dispatches++;
+  if (next_thread->pid != prev_pid) { // process switch
+    add_event(Event(Event::Type::PROCESS_DISPATCH_COMPLETED,
+                    event->time + process_switch_overhead,
+                    next_thread->index,
+                    dec));
     // change the system stats
     stats.dispatch_time += process_switch_overhead;
   } else { // thread switch
-    e = new Event(Event::Type::THREAD_DISPATCH_COMPLETED,
-                 event->time + thread_switch_overhead,
-                 next_thread,
-                 dec);
+    add_event(Event(Event::Type::THREAD_DISPATCH_COMPLETED,
+                    event->time + thread_switch_overhead,
+                    next_thread->index,
+                    dec));
     stats.dispatch_time += thread_switch_overhead;
   }
-  add_event(e);
 
   // the logger won't print for DISPATCHER_INVOKED since it is called with a nullptr thread,
   // call it in this function for the custom message
-  logger.print_verbose(event, e->thread, dec->explanation);
+  logger.print_dispatch(event, next_thread, dec);
+  if (trace) trace_decision(event, dec);
+
+  active_thread = next_thread->index; // set here to show that the processor is busy
+}
+
+
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::preempt_if_needed(const Event* event) {
+  // a thread that is still being dispatched is considered once it starts
+  // running, and one whose run ends now has nothing left to preempt
+  if (active_thread == NO_THREAD) return;
+  Thread* running = &run_state->threads[active_thread];
+  if (running->current_state != Thread::State::RUNNING) {
+    recheck_after_dispatch = true;
+    return;
+  }
+  if (run_end_time <= (size_t) event->time) return;
+
+  size_t ran = event->time - running->state_change_time;
+  if (!scheduler->should_preempt_on_arrival(event, running,
+                                            running->remaining_burst - ran)) {
+    return;
+  }
 
-  active_thread = next_thread; // set here to show that the processor is busy
+  // The event that would have ended the run is left in the queue, and
+  // dropped when it comes out, since no event queue can remove one cheaply.
+  // The preemption happens now instead, as an event that never goes through
+  // the queue.
+  Event preemption(Event::THREAD_PREEMPTED, event->time, running->index);
+  preemption.sequence = next_sequence++;
+  run_end_sequence = preemption.sequence;
+  handle_event(&preemption);
+  engine_stats.fused_events++;
+  engine_stats.num_preemptions++;
 }
 
 
-void Simulation::invoke_dispatcher(const int time) {
-  // if the provessor is idle, add a dispatch event
-  if (active_thread == nullptr) {
-    Event* e = new Event(Event::Type::DISPATCHER_INVOKED, time, nullptr);
-    add_event(e);
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::invoke_dispatcher(const int time) {
+  // if the processor is idle, ask for the dispatcher to run at the end of the
+  // current batch of events
+  if (active_thread == NO_THREAD) {
+    dispatcher_requested = true;
   }
 }
 
@@ -258,103 +539,142 @@ void Simulation::invoke_dispatcher(const int time) {
 //==============================================================================
 
 
-void Simulation::add_event(Event* event) {
-  if (event != nullptr) {
-    events.push(event);
+template <typename SchedulerT>
+size_t SimulationEngine<SchedulerT>::fast_forward(const Event* event,
+                                                  Thread* thread,
+                                                  size_t time_slice) {
+  size_t now = event->time;
+  if (!scheduler->empty() || scheduler->lone_time_slice(thread) != time_slice) {
+    return now;
   }
-}
 
+  // Each turn runs one slice, is preempted, and is dispatched again with a
+  // thread switch, since the same process ran last. Every turn skipped must
+  // leave some of the burst to run, and must end before anything else
+  // happens, so that no other thread can become ready in the meantime.
+  size_t turn_length = time_slice + thread_switch_overhead;
+  size_t turns = (thread->remaining_burst - 1) / time_slice;
+
+  size_t next_event = SIZE_MAX;
+  if (!events->empty()) next_event = events->top().time;
+  if (has_lookahead) {
+    next_event = min(next_event, (size_t) lookahead.arrival_time);
+  }
+  if (next_event <= now) return now;
+  turns = min(turns, (next_event - now - 1) / turn_length);
+  if (turns == 0) return now;
+
+  now += turns * turn_length;
+  thread->skip_time_slices(turns, time_slice, now);
+  scheduler->skip_turns(thread, turns);
+  stats.service_time += turns * time_slice;
+  stats.dispatch_time += turns * thread_switch_overhead;
+
+  // each turn would have been preempted, invoked the dispatcher and been
+  // dispatched again
+  engine_stats.skipped_events += turns * 3;
+  return now;
+}
 
-void Simulation::read_file(const string& filename) {
-  ifstream file(filename.c_str());
 
-  if (!file) {
-    cerr << "Unable to open simulation file: " << filename << endl;
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::add_event(Event event) {
+  // every event is scheduled at most one burst, slice or overhead after a
+  // time that fit in an int, so a time that no longer fits has wrapped
+  // around to a negative one
+  if (event.time < 0) {
+    cerr << "Simulated time passed " << INT_MAX
+         << " ticks; the workload's times are too large to simulate" << endl;
     exit(EXIT_FAILURE);
   }
 
-  size_t num_processes;
-
-  // Read the total number of processes, as well as the dispatch overheads.
-  file >> num_processes >> thread_switch_overhead >> process_switch_overhead;
-
-  // Read in each process.
-  for (size_t p = 0; p < num_processes; p++) {
-    Process* process = read_process(file);
-
-    processes[process->pid] = process;
-  }
+  // number the events so that ties in time are broken in FIFO order
+  event.sequence = next_sequence++;
+  events->push(event);
 }
 
 
-Process* Simulation::read_process(istream& in) {
-  int pid, type;
-  size_t num_threads;
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::load(const Workload& workload) {
+  if (!overheads_overridden) {
+    thread_switch_overhead = workload.thread_switch_overhead;
+    process_switch_overhead = workload.process_switch_overhead;
+  }
 
-  // Read in the process ID, its type, and the number of threads.
-  in >> pid >> type >> num_threads;
+  // simulating the same workload again only needs its threads reset
+  if (run_state && run_state->workload == &workload) {
+    run_state->reset();
+  } else {
+    run_state.reset(new RunState(workload));
+    scheduler->set_thread_table(&run_state->threads);
+  }
 
-  // Create the process and register its existence in the processes map.
-  Process* process = new Process(pid, (Process::Type) type);
+  begin_run();
 
-  // Read in each thread in the process.
-  for (size_t tid = 0; tid < num_threads; tid++) {
-    process->threads.push_back(read_thread(in, tid, process));
+  // Add an arrival event for each thread, in order of arrival.
+  for (const Thread& thread : run_state->threads) {
+    add_event(Event(Event::THREAD_ARRIVED, thread.arrival_time, thread.index));
   }
-
-  return process;
 }
 
 
-Thread* Simulation::read_thread(istream& in, int tid, Process* process) {
-  int arrival_time;
-  size_t num_cpu_bursts;
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::begin_run() {
+  // the previous run left the event queue and the scheduler empty, so only
+  // the counters need to start again
+  assert(events->empty() && scheduler->empty());
+  stats = SystemStats();
+  engine_stats = EngineStats();
+  next_sequence = 0;
+  dispatcher_requested = false;
+  preemption_requested = false;
+  recheck_after_dispatch = false;
+  run_end_sequence = SIZE_MAX;
+  run_end_time = 0;
+  active_thread = NO_THREAD;
+  prev_pid = -1;
+  scheduler->begin_run();
+  // skipped events could not be traced or printed
+  skipping = fast_forward_enabled && trace == nullptr && !logger.is_verbose();
+}
 
-  // Read in the thread's arrival time and its number of CPU bursts.
-  in >> arrival_time >> num_cpu_bursts;
 
-  Thread* thread = new Thread(arrival_time, tid, process);
+template <typename SchedulerT>
+void SimulationEngine<SchedulerT>::feed_arrivals() {
+  // queue every streamed thread that arrives no later than the next event, so
+  // that nothing is read before it is needed
+  while (has_lookahead
+         && (events->empty() || lookahead.arrival_time <= events->top().time)) {
+    if (lookahead.arrival_time < last_arrival_time) {
+      cerr << "Streamed simulation files must be sorted by arrival time" << endl;
+      exit(EXIT_FAILURE);
+    }
+    last_arrival_time = lookahead.arrival_time;
 
-  // Read in each burst in the thread.
-  for (size_t n = 0, burst_length; n < num_cpu_bursts * 2 - 1; n++) {
-    in >> burst_length;
+    Thread& thread = run_state->add_thread(lookahead.pid, lookahead.type,
+                                           lookahead.id, lookahead.arrival_time);
+    // the lookahead is reused for the next thread, so take a copy
+    thread.owned_bursts.reset(new int[lookahead.bursts.size()]);
+    copy(lookahead.bursts.begin(), lookahead.bursts.end(),
+         thread.owned_bursts.get());
+    thread.set_bursts(thread.owned_bursts.get(), lookahead.bursts.size());
 
-    Burst::Type burst_type = (n % 2 == 0)
-        ? Burst::CPU
-        : Burst::IO;
+    add_event(Event(Event::THREAD_ARRIVED, thread.arrival_time, thread.index));
 
-    thread->bursts.push(new Burst(burst_type, burst_length));
+    has_lookahead = stream->next(lookahead);
   }
-
-  // Add an arrival event for the thread.
-  events.push(new Event(Event::THREAD_ARRIVED, thread->arrival_time, thread));
-
-  return thread;
 }
 
 
-SystemStats Simulation::calculate_statistics() {
+template <typename SchedulerT>
+SystemStats SimulationEngine<SchedulerT>::calculate_statistics() {
   stats.total_cpu_time = stats.service_time + stats.dispatch_time;
   stats.total_idle_time = stats.total_time - stats.total_cpu_time;
   stats.cpu_utilization = (double)stats.total_cpu_time / (double)stats.total_time * 100.0;
   stats.cpu_efficiency = (double)stats.service_time / (double)stats.total_time * 100.0;
 
-  // sum up all the threads and their reponse and turnaround times
-  for (pair<int, Process*> entry : processes) {
-    Process* proc = entry.second;
-    stats.thread_counts[proc->type] += proc->threads.size();
-
-    double res_time = 0.0;
-    double ta_time = 0.0;
-    for (Thread* t : proc->threads) {
-      res_time += t->response_time();
-      ta_time += t->turnaround_time();
-    }
-    stats.avg_thread_response_times[proc->type] += res_time;
-    stats.avg_thread_turnaround_times[proc->type] += ta_time;
-  }
-  
-  // make the stats averages
+  // the reponse and turnaround times of each thread were summed up as it
+  // exited, so make the stats averages
   for (int i = 0; i < 4; i++) {
     // don't divide by zero
     if (stats.thread_counts[i] > 0) {
@@ -365,3 +685,46 @@ SystemStats Simulation::calculate_statistics() {
 
   return stats;
 }
+
+
+//==============================================================================
+// Instantiation
+//==============================================================================
+
+
+// the built-in schedulers get engines of their own, and anything else goes
+// through the virtual interface
+template class SimulationEngine<Scheduler>;
+template class SimulationEngine<FcfsScheduler>;
+template class SimulationEngine<RoundRobinScheduler>;
+template class SimulationEngine<PriorityScheduler>;
+template class SimulationEngine<MultilevelFeedbackScheduler>;
+template class SimulationEngine<SrtfScheduler>;
+template class SimulationEngine<SpnScheduler>;
+template class SimulationEngine<CfsScheduler>;
+
+
+// returns an engine specialized for T if the scheduler is exactly a T
+template <typename T>
+static Simulation* instantiate_as(Scheduler* scheduler, EventQueue* events,
+                                  const Logger& logger) {
+  T* specific = dynamic_cast<T*>(scheduler);
+  return specific ? new SimulationEngine<T>(specific, events, logger) : nullptr;
+}
+
+
+Simulation* instantiate_simulation(Scheduler* scheduler, EventQueue* events,
+                                   Logger logger) {
+  // the built-in schedulers are final, so a successful cast means the exact
+  // type is known
+  Simulation* simulation = nullptr;
+  if (!simulation) simulation = instantiate_as<FcfsScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = instantiate_as<RoundRobinScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = instantiate_as<PriorityScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = instantiate_as<MultilevelFeedbackScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = instantiate_as<SrtfScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = instantiate_as<SpnScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = instantiate_as<CfsScheduler>(scheduler, events, logger);
+  if (!simulation) simulation = new SimulationEngine<Scheduler>(scheduler, events, logger);
+  return simulation;
+}
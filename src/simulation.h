@@ -1,66 +1,234 @@
 #pragma once
 #include "algorithms/scheduler.h"
+#include "event_queues/event_queue.h"
+#include "types/engine_stats.h"
 #include "types/event.h"
 #include "types/process.h"
+#include "types/run_state.h"
+#include "types/scheduling_decision.h"
 #include "types/system_stats.h"
+#include "types/workload.h"
+#include "util/event_trace.h"
 #include "util/logger.h"
-#include <fstream>
-#include <map>
-#include <queue>
+#include "util/object_pool.h"
+#include "util/workload_reader.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 
-typedef std::priority_queue<const Event *, std::vector<const Event *>,
-                            EventComparator>
-    EventQueue;
+/**
+ * Runs simulations of workloads. Create one with instantiate_simulation().
+ */
+class Simulation {
+public:
 
+  virtual ~Simulation() {}
 
-class Simulation {
+  /**
+   * Simulates the given workload and prints the results.
+   */
+  virtual void run(const Workload& workload) = 0;
+
+  /**
+   * Simulates the given workload and returns the resulting statistics without
+   * printing them. The workload is not modified. Simulating the same workload
+   * again reuses this run's processes and threads instead of creating them
+   * anew.
+   */
+  virtual SystemStats simulate(const Workload& workload) = 0;
+
+  /**
+   * Simulates a workload as it is read, and prints the results. The input
+   * must be sorted by arrival time.
+   */
+  virtual void run(WorkloadStream& workload) = 0;
+
+  /**
+   * Simulates a workload as it is read, and returns the resulting statistics.
+   * Threads are only read shortly before they arrive and are freed as soon as
+   * they exit, so memory use depends on how many threads are alive at once
+   * rather than on the size of the input.
+   */
+  virtual SystemStats simulate(WorkloadStream& workload) = 0;
+
+  /**
+   * Uses the given switch overheads instead of the ones in the workload.
+   */
+  virtual void set_switch_overheads(size_t thread_switch, size_t process_switch) = 0;
+
+  /**
+   * Records every handled event to the given trace, which must outlive the
+   * simulation.
+   */
+  virtual void set_trace(EventTraceWriter* trace) = 0;
+
+  /**
+   * Sets whether a thread that has the CPU to itself may be moved straight
+   * to the end of the time slices it would spend alone, rather than being
+   * preempted and dispatched again once per slice. The results are the same
+   * either way. It is on by default, and never happens while events are
+   * traced or printed.
+   */
+  virtual void set_fast_forward(bool enabled) = 0;
+
+  /**
+   * Sets whether the dispatcher runs as soon as a batch of events that asked
+   * for it has been handled, rather than as an event of its own that goes
+   * through the event queue. The results and verbose output are the same
+   * either way. It is on by default.
+   */
+  virtual void set_fused_dispatch(bool enabled) = 0;
+
+  /**
+   * Returns the threads of the most recent run from a workload, in order of
+   * arrival.
+   */
+  virtual const std::vector<Thread>& threads() const = 0;
+
+  /**
+   * Returns statistics about the simulator itself from the most recent run.
+   */
+  virtual const EngineStats& engine_statistics() const = 0;
+};
+
+
+/**
+ * Creates a simulation that uses the given scheduler and event queue, which
+ * must outlive it. The built-in schedulers get an engine compiled for their
+ * exact type, so that every call into them can be inlined; any other
+ * scheduler is called through its virtual interface.
+ *
+ * On the bench corpus the specialized engines are no slower than the
+ * virtual one, but no faster beyond the noise between runs either. They are
+ * kept because the two paths give identical results, and going back to one
+ * engine would mean moving every scheduler's per-event methods out of its
+ * header again for no measured gain.
+ */
+Simulation* instantiate_simulation(Scheduler* scheduler, EventQueue* events,
+                                   Logger logger);
+
+
+/**
+ * The simulation engine, compiled separately for each type of scheduler.
+ * SchedulerT is either a final scheduler class or Scheduler itself.
+ */
+template <typename SchedulerT>
+class SimulationEngine final : public Simulation {
 // PUBLIC API METHODS
 public:
 
-  Simulation(Scheduler* scheduler, Logger logger)
-      : scheduler(scheduler), logger(logger) {}
+  SimulationEngine(SchedulerT* scheduler, EventQueue* events, Logger logger)
+      : events(events), scheduler(scheduler), logger(logger) {
+    scheduler->set_decision_pool(&decisions);
+  }
+
+  virtual void run(const Workload& workload) override;
+
+  virtual SystemStats simulate(const Workload& workload) override;
+
+  virtual void run(WorkloadStream& workload) override;
+
+  virtual SystemStats simulate(WorkloadStream& workload) override;
+
+  virtual void set_switch_overheads(size_t thread_switch,
+                                    size_t process_switch) override;
+
+  virtual void set_trace(EventTraceWriter* trace) override {
+    this->trace = trace;
+  }
+
+  virtual void set_fast_forward(bool enabled) override {
+    fast_forward_enabled = enabled;
+  }
 
-  void run(const std::string& filename);
+  virtual void set_fused_dispatch(bool enabled) override {
+    fused_dispatch = enabled;
+  }
+
+  virtual const std::vector<Thread>& threads() const override {
+    return run_state->threads;
+  }
+
+  virtual const EngineStats& engine_statistics() const override {
+    return engine_stats;
+  }
 
 // EVENT HANDLING METHODS
 private:
 
-  void handle_thread_arrived(const Event* event);
+  /**
+   * Handles events until the event queue (and the input stream, if any) is
+   * exhausted.
+   */
+  void process_events();
+
+  /**
+   * Dispatches a single event to the handler for its type, and logs the
+   * resulting state transition.
+   */
+  void handle_event(const Event* event);
+
+  void handle_thread_arrived(const Event* event, Thread* thread);
 
-  void handle_thread_dispatch_completed(const Event* event);
+  void handle_thread_dispatch_completed(const Event* event, Thread* thread);
 
-  void handle_process_dispatch_completed(const Event* event);
+  void handle_process_dispatch_completed(const Event* event, Thread* thread);
 
-  void handle_cpu_burst_completed(const Event* event);
+  void handle_cpu_burst_completed(const Event* event, Thread* thread);
 
-  void handle_io_burst_completed(const Event* event);
+  void handle_io_burst_completed(const Event* event, Thread* thread);
 
-  void handle_thread_completed(const Event* event);
+  void handle_thread_completed(const Event* event, Thread* thread);
 
-  void handle_thread_preempted(const Event* event);
+  void handle_thread_preempted(const Event* event, Thread* thread);
 
   void handle_dispatcher_invoked(const Event* event);
 
+  /**
+   * Called after an event has made a thread ready, or has finished
+   * dispatching a thread when another became ready during the dispatch. Asks
+   * the scheduler whether the running thread should give way, and if so
+   * preempts it at once, crediting it with the part of its run that it got.
+   */
+  void preempt_if_needed(const Event* event);
+
+  /**
+   * Requests that the dispatcher run at the end of the current batch of events
+   * if the processor is idle.
+   */
   void invoke_dispatcher(const int time);
 
 // UTILITY METHODS
 private:
 
   /**
-   * Reads the given file and populates the initial event queue.
+   * Creates this run's processes and threads from the given workload, or
+   * resets them if the workload was simulated before, and populates the
+   * initial event queue.
+   */
+  void load(const Workload& workload);
+
+  /**
+   * Clears the statistics and counters left over from the previous run.
    */
-  void read_file(const std::string& filename);
+  void begin_run();
 
   /**
-   * Reads a single process and its threads from the given input stream.
+   * When streaming, reads threads and adds their arrival events until the
+   * next thread to be read arrives after the earliest queued event.
    */
-  Process* read_process(std::istream& in);
+  void feed_arrivals();
 
   /**
-   * Reads a single thread frmo the given input stream.
+   * Called when the given thread has just been dispatched for a time slice
+   * shorter than its CPU burst. If no other thread is ready, and the
+   * scheduler would keep handing the thread the same slice, skips over as
+   * many of its turns as end before the next pending event, with the same
+   * effect as simulating them. Returns the time from which the thread is
+   * running.
    */
-  Thread* read_thread(std::istream& in, int tid, Process* process);
+  size_t fast_forward(const Event* event, Thread* thread, size_t time_slice);
 
   /**
    * Calculates the overall statistics for the simulation.
@@ -68,9 +236,23 @@ private:
   SystemStats calculate_statistics();
 
   /**
-   * Adds an event to the event queue.
+   * Assigns the next sequence number to an event and adds it to the event
+   * queue. Exits if the event's time has overflowed.
+   */
+  void add_event(Event event);
+
+  /**
+   * Records a handled event to the trace. `thread` is the event's thread, or
+   * NULL if it has none.
+   */
+  void trace_event(const Event* event, const Thread* thread,
+                   Thread::State old_state, Thread::State new_state);
+
+  /**
+   * Records a DISPATCHER_INVOKED event that chose a thread, followed by the
+   * rest of the decision.
    */
-  void add_event(Event* event);
+  void trace_decision(const Event* event, const SchedulingDecision* decision);
 
 // CLASS INSTANCE VARIABLES
 private:
@@ -79,39 +261,104 @@ private:
   // or delete.  :)
 
   /**
-   * Map of PIDs to their corresponding processes.
+   * The processes and threads of the current run, which events, decisions
+   * and the scheduler refer to by index.
    */
-  std::map<int, Process*> processes;
+  std::unique_ptr<RunState> run_state;
 
   /**
    * The event queue containing all the events that still need to be processed.
    */
-  EventQueue events;
+  EventQueue* events;
 
   /**
    * The scheduler instance to use.
    */
-  Scheduler* scheduler;
+  SchedulerT* scheduler;
 
   /**
    * The logger to use.
    */
   Logger logger;
 
+  /**
+   * Where handled events are recorded, or NULL.
+   */
+  EventTraceWriter* trace = nullptr;
+
   /**
    * An object for storing various counters and metrics.
    */
   SystemStats stats;
 
   /**
-   * The thread that is currently executing, or NULL.
+   * Counters describing the work done by the simulator itself.
+   */
+  EngineStats engine_stats;
+
+  /**
+   * The pool that all scheduling decisions are allocated from. A decision is
+   * returned to the pool by the handler of the last event that refers to it.
+   */
+  ObjectPool<SchedulingDecision> decisions;
+
+  /**
+   * The sequence number to give to the next event added to the queue.
+   */
+  size_t next_sequence = 0;
+
+  /**
+   * Whether fast_forward() may skip ahead, as set by set_fast_forward().
+   */
+  bool fast_forward_enabled = true;
+
+  /**
+   * Whether fast_forward() may skip ahead in the current run, which it may
+   * not while events are being traced or printed.
+   */
+  bool skipping = false;
+
+  /**
+   * Whether the dispatcher is run without going through the event queue, as
+   * set by set_fused_dispatch().
+   */
+  bool fused_dispatch = true;
+
+  /**
+   * Whether the event being handled made a thread ready, so that the running
+   * thread may need to be preempted.
+   */
+  bool preemption_requested = false;
+
+  /**
+   * Whether a thread became ready while the active thread was being
+   * dispatched, so that preemption must be considered once it is running.
+   */
+  bool recheck_after_dispatch = false;
+
+  /**
+   * The sequence number of the event that ends the running thread's current
+   * run, and the time of that event. An event that once ended a run but has
+   * another sequence number was cancelled by a preemption.
    */
-  Thread* active_thread = nullptr;
+  size_t run_end_sequence = SIZE_MAX;
+  size_t run_end_time = 0;
 
   /**
-   * The thread that previously executed, or NULL.
+   * Whether an event in the current batch has asked for the dispatcher to run.
    */
-  Thread* prev_thread = nullptr;
+  bool dispatcher_requested = false;
+
+  /**
+   * The thread that is currently executing, or NO_THREAD.
+   */
+  ThreadIndex active_thread = NO_THREAD;
+
+  /**
+   * The PID of the process whose thread previously executed, or -1. This is a
+   * PID rather than a thread, since a streamed thread is freed once it exits.
+   */
+  int prev_pid = -1;
 
   /**
    * The amount of overhead required to switch between two threads within the
@@ -123,4 +370,31 @@ private:
    * The amount of overhead required to switch between two processes.
    */
   size_t process_switch_overhead;
+
+  /**
+   * Whether the switch overheads were set explicitly, rather than being taken
+   * from the workload.
+   */
+  bool overheads_overridden = false;
+
+  /**
+   * The stream that threads are read from while they are being simulated, or
+   * NULL if the whole workload was loaded up front.
+   */
+  WorkloadStream* stream = nullptr;
+
+  /**
+   * The next thread to be read from the stream.
+   */
+  ThreadRecord lookahead;
+
+  /**
+   * Whether `lookahead` holds a thread that has not been queued yet.
+   */
+  bool has_lookahead = false;
+
+  /**
+   * The arrival time of the last thread read from the stream.
+   */
+  int last_arrival_time = 0;
 };
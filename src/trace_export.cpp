@@ -0,0 +1,139 @@
+#include "trace_export.h"
+#include "util/event_trace.h"
+#include "util/logger.h"
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+
+using namespace std;
+
+
+/**
+ * The state a thread is currently in, and since when.
+ */
+struct OpenSpan {
+  uint8_t state;
+  int32_t start;
+};
+
+
+/**
+ * Receives each finished span of time that a thread spent in one state.
+ */
+struct SpanWriter {
+  virtual void begin() = 0;
+  virtual void span(int32_t pid, int32_t tid, uint8_t state, int32_t start,
+                    int32_t end) = 0;
+  virtual void dispatch(const TraceRecord& invoked,
+                        const TraceRecord& decision) = 0;
+  virtual void end() = 0;
+  virtual ~SpanWriter() {}
+};
+
+
+/**
+ * Writes Chrome trace-event JSON, which chrome://tracing and Perfetto can
+ * display. Simulation time units are shown as microseconds.
+ */
+struct ChromeWriter : SpanWriter {
+  bool first = true;
+
+  void separate() {
+    fputs(first ? "\n" : ",\n", stdout);
+    first = false;
+  }
+
+  virtual void begin() override {
+    fputs("{\"traceEvents\":[", stdout);
+  }
+
+  virtual void span(int32_t pid, int32_t tid, uint8_t state, int32_t start,
+                    int32_t end) override {
+    separate();
+    printf("{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,"
+           "\"pid\":%d,\"tid\":%d}",
+           STATE_MAP[state], start, end - start, pid, tid);
+  }
+
+  virtual void dispatch(const TraceRecord& invoked,
+                        const TraceRecord& decision) override {
+    separate();
+    printf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%d,"
+           "\"args\":{\"pid\":%d,\"tid\":%d,\"time_slice\":%d,"
+           "\"level\":%d,\"candidates\":%u}}",
+           EVENT_MAP[invoked.type], invoked.time, invoked.thread.pid,
+           invoked.thread.tid, decision.decision.time_slice,
+           invoked.level == TraceRecord::NONE ? -1 : (int) invoked.level,
+           decision.decision.candidates);
+  }
+
+  virtual void end() override {
+    fputs("\n]}\n", stdout);
+  }
+};
+
+
+/**
+ * Writes one CSV row per span, suitable for drawing a Gantt chart.
+ */
+struct GanttWriter : SpanWriter {
+  virtual void begin() override {
+    fputs("pid,tid,state,start,end\n", stdout);
+  }
+
+  virtual void span(int32_t pid, int32_t tid, uint8_t state, int32_t start,
+                    int32_t end) override {
+    printf("%d,%d,%s,%d,%d\n", pid, tid, STATE_MAP[state], start, end);
+  }
+
+  virtual void dispatch(const TraceRecord& invoked,
+                        const TraceRecord& decision) override {}
+
+  virtual void end() override {}
+};
+
+
+void export_trace(const ExportOptions& options) {
+  EventTraceReader trace(options.trace);
+
+  ChromeWriter chrome;
+  GanttWriter gantt;
+  SpanWriter& writer = (options.format == "GANTT")
+      ? static_cast<SpanWriter&>(gantt) : chrome;
+
+  // the state each live thread is in, keyed by PID and thread ID
+  unordered_map<uint64_t, OpenSpan> open_spans;
+
+  writer.begin();
+  for (const TraceRecord* record = trace.begin(); record != trace.end();
+       record++) {
+    int32_t pid = record->thread.pid, tid = record->thread.tid;
+    if (record->type == Event::DISPATCHER_INVOKED) {
+      if (pid >= 0 && record + 1 != trace.end()
+          && record[1].type == TraceRecord::DECISION) {
+        writer.dispatch(*record, record[1]);
+        record++;
+      }
+      continue;
+    }
+    if (record->type == TraceRecord::DECISION || pid < 0
+        || record->old_state == record->new_state) {
+      continue;
+    }
+
+    uint64_t key = ((uint64_t) (uint32_t) pid << 32) | (uint32_t) tid;
+    auto found = open_spans.find(key);
+    if (found != open_spans.end()) {
+      const OpenSpan& span = found->second;
+      if (record->time > span.start) {
+        writer.span(pid, tid, span.state, span.start, record->time);
+      }
+      open_spans.erase(found);
+    }
+
+    if (record->new_state != Thread::State::EXIT) {
+      open_spans[key] = {record->new_state, record->time};
+    }
+  }
+  writer.end();
+}
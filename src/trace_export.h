@@ -0,0 +1,10 @@
+#pragma once
+#include "util/flags.h"
+
+
+/**
+ * Reads a binary event trace and writes it to stdout in the requested format.
+ * Both formats describe the spans of time that each thread spent in each of
+ * the READY, RUNNING and BLOCKED states.
+ */
+void export_trace(const ExportOptions& options);
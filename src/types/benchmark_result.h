@@ -0,0 +1,25 @@
+#pragma once
+#include "types/engine_stats.h"
+#include <cstddef>
+#include <string>
+
+
+/**
+ * The outcome of benchmarking one scheduling algorithm on one workload.
+ */
+struct BenchmarkResult {
+  /**
+   * The name of the scheduling algorithm.
+   */
+  std::string algorithm;
+
+  /**
+   * The number of processes in the workload.
+   */
+  size_t num_processes = 0;
+
+  /**
+   * The statistics of the fastest repetition.
+   */
+  EngineStats stats;
+};
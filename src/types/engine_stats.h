@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+
+
+/**
+ * Encapsulates statistics about the simulator itself, as opposed to the
+ * simulated system.
+ */
+struct EngineStats {
+
+  /**
+   * The number of events handled, whether or not they went through the
+   * event queue.
+   */
+  size_t num_events = 0;
+
+  /**
+   * The number of handled events that never went through the event queue,
+   * because they were handled as soon as they were created.
+   */
+  size_t fused_events = 0;
+
+  /**
+   * The number of events left in the event queue by a preemption that made
+   * them obsolete, and dropped when they came out.
+   */
+  size_t cancelled_events = 0;
+
+  /**
+   * The number of running threads preempted because another thread became
+   * ready.
+   */
+  size_t num_preemptions = 0;
+
+  /**
+   * The number of times the dispatcher chose a thread to run.
+   */
+  size_t num_dispatches = 0;
+
+  /**
+   * The average number of events that went through the event queue for each
+   * thread dispatched.
+   */
+  double queued_events_per_dispatch = 0.0;
+
+  /**
+   * The number of events that were not handled because the CPU was
+   * fast-forwarded over the time slices they belonged to.
+   */
+  size_t skipped_events = 0;
+
+  /**
+   * The number of heap allocations made while processing events.
+   */
+  size_t num_allocations = 0;
+
+  /**
+   * The number of slabs allocated for scheduling decisions.
+   */
+  size_t decision_slabs = 0;
+
+  /**
+   * The average number of heap allocations per handled event.
+   */
+  double allocations_per_event = 0.0;
+
+  /**
+   * The wall-clock time spent processing events, in seconds.
+   */
+  double seconds = 0.0;
+
+  /**
+   * The number of events handled per second of wall-clock time.
+   */
+  double events_per_second = 0.0;
+
+  /**
+   * The peak resident set size of the simulator process, in kilobytes.
+   */
+  size_t peak_rss_kb = 0;
+};
@@ -64,9 +64,15 @@ struct Event {
   int time;
 
   /**
-   * The thread for which the event applies.
+   * The order in which the event was added to the event queue, used to break
+   * ties between events that occur at the same time.
    */
-  Thread* thread;
+  size_t sequence = 0;
+
+  /**
+   * The thread for which the event applies, or NO_THREAD.
+   */
+  ThreadIndex thread;
 
   /**
    * The associated scheduling decision, if any.
@@ -76,24 +82,19 @@ struct Event {
   /**
    * Constructor.
    */
-  Event(Type type, int time, Thread* thread)
+  Event(Type type, int time, ThreadIndex thread)
       : Event(type, time, thread, nullptr) {}
 
   /**
    * Constructor.
    */
-  Event(Type type, int time, Thread* thread, const SchedulingDecision* sd)
+  Event(Type type, int time, ThreadIndex thread, const SchedulingDecision* sd)
       : type(type), time(time), thread(thread), scheduling_decision(sd) {}
-
-  /**
-   * Destructor.
-   */
-  ~Event() { delete scheduling_decision; }
 };
 
 
 /**
- * Comparator for std::priority_queue to correctly order event pointers.
+ * Comparator for std::priority_queue to correctly order events.
  *
  * A binary predicate that takes two events as arguments and returns a bool.
  * The expression comp(a, b), where comp is an object of this type and a and b
@@ -101,10 +102,17 @@ struct Event {
  * before b in the strict weak ordering the function defines.
  *
  * The priority queue will return the 'greatest' element, so larger times should
- * be considered 'smaller' in terms of priority.
+ * be considered 'smaller' in terms of priority. Events at the same time are
+ * ordered by sequence number, so that they come out in the order they were
+ * added, except that arrivals come before everything else. That way the order
+ * doesn't depend on whether arrivals were queued up front or streamed in.
  */
 struct EventComparator {
-  bool operator()(const Event* e1, const Event* e2) {
-     return e1->time >= e2->time;
+  bool operator()(const Event& e1, const Event& e2) const {
+    if (e1.time != e2.time) return e1.time > e2.time;
+    bool arrived1 = e1.type == Event::THREAD_ARRIVED;
+    bool arrived2 = e2.type == Event::THREAD_ARRIVED;
+    if (arrived1 != arrived2) return arrived2;
+    return e1.sequence > e2.sequence;
   }
 };
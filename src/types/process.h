@@ -1,5 +1,5 @@
 #pragma once
-#include "thread.h"
+#include <cstdint>
 #include <vector>
 
 
@@ -29,9 +29,10 @@ struct Process {
   Type type;
 
   /**
-   * All threads belonging to this process.
+   * The indices of all threads belonging to this process in the run's thread
+   * table, in thread ID order.
    */
-  std::vector<Thread*> threads;
+  std::vector<uint32_t> threads;
 
   /**
    * Constructor.
@@ -0,0 +1,106 @@
+#include "types/run_state.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+
+RunState::RunState(const Workload& workload) : workload(&workload) {
+  processes.reserve(workload.processes.size());
+  for (const ProcessSpec& spec : workload.processes) {
+    processes.emplace_back(spec.pid, spec.type);
+  }
+
+  // lay the threads out in the order they will arrive, so that the
+  // simulation walks the table front to back
+  vector<size_t> order(workload.threads.size());
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(), [&workload](size_t a, size_t b) {
+    return workload.threads[a].arrival_time < workload.threads[b].arrival_time;
+  });
+
+  threads.reserve(workload.threads.size());
+  vector<ThreadIndex> indices(workload.threads.size());
+  for (size_t t : order) {
+    const ThreadSpec& spec = workload.threads[t];
+    threads.emplace_back(spec.arrival_time, spec.id,
+                         processes[spec.process], spec.process);
+    Thread& thread = threads.back();
+    thread.index = indices[t] = threads.size() - 1;
+
+    // the thread keeps its progress itself, so it can share the workload's
+    // bursts rather than copying them
+    thread.set_bursts(&workload.bursts[spec.first_burst], spec.num_bursts);
+  }
+
+  for (size_t p = 0; p < processes.size(); p++) {
+    const ProcessSpec& spec = workload.processes[p];
+    for (size_t t = spec.first_thread; t < spec.first_thread + spec.num_threads; t++) {
+      processes[p].threads.push_back(indices[t]);
+    }
+  }
+}
+
+
+void RunState::reset() {
+  for (Thread& thread : threads) {
+    thread.reset();
+  }
+}
+
+
+Thread& RunState::add_thread(int pid, Process::Type type, int id,
+                             size_t arrival_time) {
+  // the process is created again if all of its earlier threads have exited
+  auto found = live_processes.find(pid);
+  uint32_t process;
+  if (found != live_processes.end()) {
+    process = found->second;
+  } else if (!free_processes.empty()) {
+    process = free_processes.back();
+    free_processes.pop_back();
+    processes[process] = Process(pid, type);
+    live_processes[pid] = process;
+  } else {
+    process = processes.size();
+    processes.emplace_back(pid, type);
+    live_processes[pid] = process;
+  }
+
+  ThreadIndex index;
+  if (!free_threads.empty()) {
+    index = free_threads.back();
+    free_threads.pop_back();
+    threads[index] = Thread(arrival_time, id, processes[process], process);
+  } else {
+    index = threads.size();
+    threads.emplace_back(arrival_time, id, processes[process], process);
+  }
+
+  Thread& thread = threads[index];
+  thread.index = index;
+  processes[process].threads.push_back(index);
+  return thread;
+}
+
+
+void RunState::remove_thread(ThreadIndex index) {
+  Thread& thread = threads[index];
+  Process& process = processes[thread.process];
+
+  for (size_t i = 0; i < process.threads.size(); i++) {
+    if (process.threads[i] == index) {
+      process.threads[i] = process.threads.back();
+      process.threads.pop_back();
+      break;
+    }
+  }
+
+  thread.owned_bursts.reset();
+  free_threads.push_back(index);
+
+  if (process.threads.empty()) {
+    live_processes.erase(process.pid);
+    free_processes.push_back(thread.process);
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "types/process.h"
+#include "types/thread.h"
+#include "types/workload.h"
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * Everything about a workload's processes and threads that changes while it
+ * is simulated, kept in two dense tables. Processes and threads are referred
+ * to by their positions in these tables. The workload itself is only read, so
+ * a run state can be reset and simulated again, and several run states can
+ * share one workload.
+ */
+struct RunState {
+  /**
+   * Creates empty tables, which streamed threads are added to as they arrive.
+   */
+  RunState() {}
+
+  /**
+   * Creates a process for each process in the workload and a thread for each
+   * of its threads, with the threads in order of arrival. The workload must
+   * outlive the run state.
+   */
+  explicit RunState(const Workload& workload);
+
+  RunState(const RunState&) = delete;
+  RunState& operator=(const RunState&) = delete;
+
+  /**
+   * Returns every thread to the state it was in before it arrived.
+   */
+  void reset();
+
+  /**
+   * Adds a streamed thread to the process with the given PID, creating the
+   * process if it has no live threads, and returns the thread. Slots freed by
+   * remove_thread() are reused, so the tables only grow as large as the
+   * number of threads alive at once. Adding may move every thread in memory.
+   */
+  Thread& add_thread(int pid, Process::Type type, int id, size_t arrival_time);
+
+  /**
+   * Frees a streamed thread's slot, and its process's slot if that was the
+   * process's last thread.
+   */
+  void remove_thread(ThreadIndex index);
+
+  /**
+   * The workload that the run state was created from, or NULL if it holds
+   * streamed threads.
+   */
+  const Workload* workload = nullptr;
+
+  /**
+   * All processes. When loaded, these are in workload order.
+   */
+  std::vector<Process> processes;
+
+  /**
+   * All threads. When loaded, these are in order of arrival, with ties in
+   * workload order.
+   */
+  std::vector<Thread> threads;
+
+private:
+
+  /**
+   * The slots of removed processes and threads, which are reused first.
+   */
+  std::vector<uint32_t> free_processes;
+  std::vector<ThreadIndex> free_threads;
+
+  /**
+   * The slot of each streamed process that has live threads, by PID.
+   */
+  std::unordered_map<int, uint32_t> live_processes;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+
+/**
+ * A figure that a scheduler keeps about its own behaviour during a run, such
+ * as how well it predicted the threads it ran, and reports at the end.
+ */
+struct SchedulerMetric {
+  /**
+   * What the figure is, as printed.
+   */
+  std::string label;
+
+  double value;
+
+  /**
+   * The number of digits to print after the decimal point.
+   */
+  int decimals;
+};
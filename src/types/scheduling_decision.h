@@ -1,6 +1,94 @@
 #pragma once
 #include "types/thread.h"
-#include <string>
+#include <cstddef>
+
+
+/**
+ * The facts behind a scheduling choice. Schedulers fill one in on every
+ * dispatch, which costs a few stores; it is only turned into text if a logger
+ * actually prints it.
+ */
+struct Explanation {
+  /**
+   * Which kind of choice was made, and so which of the fields below are set.
+   */
+  enum Kind {
+    /**
+     * No explanation was given.
+     */
+    NONE,
+
+    /**
+     * Taken from a single queue and run until its burst completes.
+     */
+    RUN_TO_COMPLETION,
+
+    /**
+     * Taken from a single queue and run for at most one time slice.
+     */
+    TIME_SLICED,
+
+    /**
+     * Taken from the highest non-empty queue of one per process type.
+     */
+    PRIORITY_QUEUE,
+
+    /**
+     * Taken from the highest non-empty level of a multilevel feedback queue,
+     * and run for at most one time slice.
+     */
+    FEEDBACK_LEVEL,
+
+    /**
+     * Taken from a heap ordered by the time left in each thread's CPU burst,
+     * and run until it completes or a shorter thread becomes ready.
+     */
+    SHORTEST_REMAINING,
+
+    /**
+     * Taken from a heap ordered by each thread's predicted CPU burst, and run
+     * until its burst completes.
+     */
+    SHORTEST_PREDICTED,
+
+    /**
+     * Taken from a heap ordered by each thread's virtual runtime, and run for
+     * at most its share of the target latency.
+     */
+    FAIR_SHARE
+  };
+
+  Kind kind = NONE;
+
+  /**
+   * The number of threads in the queue the thread was taken from, including
+   * the thread itself.
+   */
+  size_t candidates = 0;
+
+  /**
+   * The queue or level that the thread was taken from, counting from zero.
+   */
+  int level = 0;
+
+  /**
+   * The number of levels in a FEEDBACK_LEVEL scheduler.
+   */
+  int num_levels = 0;
+
+  /**
+   * The value the thread was ordered by. For SHORTEST_REMAINING, the time
+   * left in its CPU burst; for SHORTEST_PREDICTED, its predicted burst; for
+   * FAIR_SHARE, its virtual runtime in ticks.
+   */
+  double key = 0;
+
+  /**
+   * For PRIORITY_QUEUE, the number of threads left in each queue after the
+   * choice, indexed by process type.
+   */
+  size_t queue_sizes[4];
+};
 
 
 /**
@@ -8,9 +96,10 @@
  */
 struct SchedulingDecision {
   /**
-   * The next thread to run, or NULL if there are no threads in the ready state.
+   * The next thread to run, or NO_THREAD if there are no threads in the ready
+   * state.
    */
-  Thread* thread = nullptr;
+  ThreadIndex thread = NO_THREAD;
 
   /**
    * The amount of time after which the thread should be preempted, or -1 if
@@ -19,7 +108,7 @@ struct SchedulingDecision {
   size_t time_slice = -1;
 
   /**
-   * A brief message concerning this scheduling choice.
+   * Why this thread was chosen.
    */
-  std::string explanation;
+  Explanation explanation;
 };
@@ -1,11 +1,23 @@
 #pragma once
-#include "burst.h"
+#include "types/process.h"
 #include <cassert>
-#include <queue>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
 
-// Forward declaration (circular dependency resolution).
-struct Process;
+/**
+ * Identifies a thread by its position in the run's thread table. Events,
+ * decisions and ready queues hold these rather than pointers, since they are
+ * half the size and stay valid when the table grows.
+ */
+typedef uint32_t ThreadIndex;
+
+
+/**
+ * The index that refers to no thread.
+ */
+const ThreadIndex NO_THREAD = UINT32_MAX;
 
 
 /**
@@ -29,6 +41,11 @@ struct Thread {
    */
   int id;
 
+  /**
+   * The position of this thread in the run's thread table.
+   */
+  ThreadIndex index = NO_THREAD;
+
   /**
    * The time at which this thread arrived
    */
@@ -67,38 +84,149 @@ struct Thread {
   /**
    * The previous state of the thread.
    */
-  State previous_state;
+  State previous_state = NEW;
+
+  /**
+   * The lengths of this thread's bursts, which alternate between CPU and IO
+   * and start and end with a CPU burst. They usually point into the
+   * workload's flat burst table, and are never modified while simulating.
+   */
+  const int* bursts = nullptr;
+
+  /**
+   * The number of bursts (CPU and IO) in the thread.
+   */
+  size_t num_bursts = 0;
+
+  /**
+   * The index of the burst that the thread is on, which reaches num_bursts
+   * once the last burst has finished.
+   */
+  size_t burst_index = 0;
+
+  /**
+   * The time left in the current burst, which shrinks each time the thread
+   * is preempted.
+   */
+  size_t remaining_burst = 0;
+
+  /**
+   * The storage behind `bursts` when the thread has its own copy of them,
+   * since a streamed thread outlives the record it was read from.
+   */
+  std::unique_ptr<int[]> owned_bursts;
+
+  /**
+   * The level of the multilevel feedback queue that this thread was last
+   * enqueued in, or -1 if it has not been enqueued in one yet.
+   */
+  int queue_level = -1;
+
+  /**
+   * The threads before and after this one in the ready list it is in, or
+   * NO_THREAD. These are only meaningful while the thread is READY.
+   */
+  ThreadIndex ready_prev = NO_THREAD;
+  ThreadIndex ready_next = NO_THREAD;
 
   /**
-   * All bursts that are a part of this thread.
+   * The position of the process associated with this thread in the run's
+   * process table.
    */
-  std::queue<Burst*> bursts;
+  uint32_t process;
 
   /**
-   * The process associated with this thread.
+   * The ID and type of the process, copied from it so that dispatching and
+   * logging need not look the process up.
    */
-  Process* process;
+  int pid;
+  Process::Type type;
 
   /**
    * Constructor.
    */
-  Thread(size_t arrival, int id, Process* process) :
+  Thread(size_t arrival, int id, const Process& process, uint32_t process_index) :
       id(id),
       arrival_time(arrival),
-      process(process) {}
+      process(process_index),
+      pid(process.pid),
+      type(process.type) {}
 
+  /**
+   * Returns the time between the thread's arrival and its first dispatch.
+   * This is zero when the thread is dispatched the moment it arrives with no
+   * dispatch overhead. Likewise, turnaround_time() is zero when all of the
+   * thread's bursts are empty.
+   */
   size_t response_time() const {
     assert(current_state == EXIT);
-    assert(start_time > arrival_time);
+    assert(start_time >= arrival_time);
     return start_time - arrival_time;
   }
   
   
   size_t turnaround_time() const {
     assert(current_state == EXIT);
-    assert(end_time > arrival_time);
+    assert(end_time >= arrival_time);
     return end_time - arrival_time;
   }
 
   void set_state(State state, size_t time);
+
+  /**
+   * Forgets everything that happened to the thread since it was created, so
+   * that it can be simulated again.
+   */
+  void reset() {
+    start_time = -1;
+    end_time = -1;
+    service_time = 0;
+    io_time = 0;
+    state_change_time = -1;
+    current_state = NEW;
+    queue_level = -1;
+    ready_prev = NO_THREAD;
+    ready_next = NO_THREAD;
+    burst_index = 0;
+    remaining_burst = bursts[0];
+  }
+
+  /**
+   * Gives the thread its bursts and starts it on the first one.
+   */
+  void set_bursts(const int* bursts, size_t num_bursts) {
+    assert(num_bursts % 2 == 1);
+    this->bursts = bursts;
+    this->num_bursts = num_bursts;
+    burst_index = 0;
+    remaining_burst = bursts[0];
+  }
+
+  /**
+   * Returns whether the current burst is a CPU burst.
+   */
+  bool in_cpu_burst() const {
+    return burst_index < num_bursts && burst_index % 2 == 0;
+  }
+
+  /**
+   * Accounts for `turns` time slices of the current CPU burst that were not
+   * simulated one by one, each followed by a wait to be dispatched again, so
+   * that the thread is running from `time` with the rest of the burst left.
+   */
+  void skip_time_slices(size_t turns, size_t time_slice, size_t time) {
+    assert(current_state == RUNNING);
+    assert(remaining_burst > turns * time_slice);
+    service_time += turns * time_slice;
+    remaining_burst -= turns * time_slice;
+    state_change_time = time;
+  }
+
+  /**
+   * Moves on to the next burst, if there is one.
+   */
+  void finish_burst() {
+    burst_index++;
+    remaining_burst = burst_index < num_bursts ? bursts[burst_index] : 0;
+  }
 };
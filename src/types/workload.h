@@ -0,0 +1,104 @@
+#pragma once
+#include "types/process.h"
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * The largest thread or process switch overhead a workload may have. An
+ * overhead is added to the simulated clock, an int, on every dispatch, so it
+ * is kept far enough below INT_MAX that a long simulation does not overflow
+ * from overheads alone.
+ */
+const size_t MAX_SWITCH_OVERHEAD = 1000000;
+
+
+/**
+ * Describes a single thread in a workload.
+ */
+struct ThreadSpec {
+  /**
+   * The ID of the thread within its process.
+   */
+  int id;
+
+  /**
+   * The time at which the thread arrives.
+   */
+  int arrival_time;
+
+  /**
+   * The index of the thread's process in Workload::processes.
+   */
+  size_t process;
+
+  /**
+   * The index of the thread's first burst in Workload::bursts.
+   */
+  size_t first_burst;
+
+  /**
+   * The number of bursts (CPU and IO) in the thread.
+   */
+  size_t num_bursts;
+};
+
+
+/**
+ * Describes a single process in a workload.
+ */
+struct ProcessSpec {
+  /**
+   * The ID of the process.
+   */
+  int pid;
+
+  /**
+   * The type of the process.
+   */
+  Process::Type type;
+
+  /**
+   * The index of the process's first thread in Workload::threads.
+   */
+  size_t first_thread;
+
+  /**
+   * The number of threads in the process.
+   */
+  size_t num_threads;
+};
+
+
+/**
+ * An immutable, parsed simulation input. A workload holds no per-run state, so
+ * any number of simulations can run over the same workload at once.
+ */
+struct Workload {
+  /**
+   * The amount of overhead required to switch between two threads within the
+   * same process.
+   */
+  size_t thread_switch_overhead = 0;
+
+  /**
+   * The amount of overhead required to switch between two processes.
+   */
+  size_t process_switch_overhead = 0;
+
+  /**
+   * All processes, in the order they appear in the input.
+   */
+  std::vector<ProcessSpec> processes;
+
+  /**
+   * All threads, grouped by process.
+   */
+  std::vector<ThreadSpec> threads;
+
+  /**
+   * The lengths of all bursts, grouped by thread. Each thread's bursts
+   * alternate between CPU and IO, starting and ending with a CPU burst.
+   */
+  std::vector<int> bursts;
+};
@@ -0,0 +1,67 @@
+#include "util/allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+
+// Counts every allocation made through the global operator new. Relaxed
+// ordering is enough, since the count is only read as a statistic.
+static atomic<size_t> allocations(0);
+
+
+size_t allocation_count() {
+  return allocations.load(memory_order_relaxed);
+}
+
+
+// allocate memory with malloc, counting the allocation
+static void* counted_malloc(size_t size) {
+  allocations.fetch_add(1, memory_order_relaxed);
+  return malloc(size == 0 ? 1 : size);
+}
+
+
+void* operator new(size_t size) {
+  void* ptr = counted_malloc(size);
+  if (ptr == nullptr) throw bad_alloc();
+  return ptr;
+}
+
+
+void* operator new[](size_t size) {
+  void* ptr = counted_malloc(size);
+  if (ptr == nullptr) throw bad_alloc();
+  return ptr;
+}
+
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+  return counted_malloc(size);
+}
+
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+  return counted_malloc(size);
+}
+
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+
+void operator delete(void* ptr, const nothrow_t&) noexcept {
+  free(ptr);
+}
+
+
+void operator delete[](void* ptr, const nothrow_t&) noexcept {
+  free(ptr);
+}
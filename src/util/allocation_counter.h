@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+
+
+/**
+ * Returns the number of heap allocations (calls to any form of operator new)
+ * made by the program so far.
+ */
+size_t allocation_count();
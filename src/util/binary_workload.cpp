@@ -0,0 +1,314 @@
+#include "util/binary_workload.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+
+const uint32_t BINARY_WORKLOAD_VERSION = 1;
+
+
+/**
+ * The first eight bytes of every binary workload.
+ */
+static const char MAGIC[8] = {'S', 'I', 'M', 'B', 'I', 'N', '\r', '\n'};
+
+
+/**
+ * Written in native byte order; reads back differently on a machine with the
+ * other byte order.
+ */
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+
+// The on-disk layout. Every field has a fixed width and every record is a
+// multiple of 8 bytes, so the tables that follow the header stay aligned.
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t source_hash;
+  uint64_t thread_switch_overhead;
+  uint64_t process_switch_overhead;
+  uint64_t num_processes;
+  uint64_t num_threads;
+  uint64_t num_bursts;
+};
+
+struct FileProcess {
+  int32_t pid;
+  uint32_t type;
+  uint32_t first_thread;
+  uint32_t num_threads;
+};
+
+struct FileThread {
+  int32_t id;
+  int32_t arrival_time;
+  uint32_t process;
+  uint32_t num_bursts;
+  uint64_t first_burst;
+};
+
+static_assert(sizeof(FileHeader) == 64, "unexpected header padding");
+static_assert(sizeof(FileProcess) == 16, "unexpected process padding");
+static_assert(sizeof(FileThread) == 24, "unexpected thread padding");
+
+
+uint64_t hash_bytes(const char* data, size_t size) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= (unsigned char) data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+
+bool is_binary_workload(const MappedFile& file) {
+  return file.size() >= sizeof(MAGIC)
+      && memcmp(file.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+
+// returns the header if the file is a readable binary workload, else NULL
+static const FileHeader* read_header(const MappedFile& file) {
+  if (!is_binary_workload(file) || file.size() < sizeof(FileHeader)) {
+    return nullptr;
+  }
+
+  const FileHeader* header = reinterpret_cast<const FileHeader*>(file.data());
+  if (header->version != BINARY_WORKLOAD_VERSION
+      || header->byte_order != BYTE_ORDER_MARK) {
+    return nullptr;
+  }
+  return header;
+}
+
+
+bool read_binary_source_hash(const MappedFile& file, uint64_t& source_hash) {
+  const FileHeader* header = read_header(file);
+  if (header == nullptr) return false;
+
+  source_hash = header->source_hash;
+  return true;
+}
+
+
+[[noreturn]] static void fail(const string& filename, const string& message) {
+  cerr << filename << ": " << message << endl;
+  exit(EXIT_FAILURE);
+}
+
+
+Workload read_binary_workload(const MappedFile& file, const string& filename) {
+  const FileHeader* header = read_header(file);
+  if (header == nullptr) {
+    fail(filename, "not a binary workload of version "
+         + to_string(BINARY_WORKLOAD_VERSION) + " in native byte order");
+  }
+
+  // Everything after the header must be exactly the three tables.
+  uint64_t expected_size = sizeof(FileHeader)
+      + header->num_processes * sizeof(FileProcess)
+      + header->num_threads * sizeof(FileThread)
+      + header->num_bursts * sizeof(int32_t);
+  if (header->num_processes > file.size() || header->num_threads > file.size()
+      || header->num_bursts > file.size() || expected_size != file.size()) {
+    fail(filename, "file size does not match the table sizes in its header");
+  }
+
+  const FileProcess* processes =
+      reinterpret_cast<const FileProcess*>(header + 1);
+  const FileThread* threads =
+      reinterpret_cast<const FileThread*>(processes + header->num_processes);
+  const int32_t* bursts =
+      reinterpret_cast<const int32_t*>(threads + header->num_threads);
+
+  // the overheads are added to the simulated time on every dispatch
+  if (header->thread_switch_overhead > MAX_SWITCH_OVERHEAD
+      || header->process_switch_overhead > MAX_SWITCH_OVERHEAD) {
+    fail(filename, "switch overheads must be at most "
+                   + to_string(MAX_SWITCH_OVERHEAD)
+                   + ", since they are added to the simulated time on every "
+                     "dispatch");
+  }
+
+  Workload workload;
+  workload.thread_switch_overhead = header->thread_switch_overhead;
+  workload.process_switch_overhead = header->process_switch_overhead;
+  workload.processes.resize(header->num_processes);
+  workload.threads.resize(header->num_threads);
+  workload.bursts.assign(bursts, bursts + header->num_bursts);
+
+  // a negative burst would become an enormous unsigned one when simulated
+  for (size_t b = 0; b < header->num_bursts; b++) {
+    if (bursts[b] < 0) {
+      fail(filename, "burst " + to_string(b) + ": burst length must be at least 0");
+    }
+  }
+
+  // Threads must be grouped by process, and bursts by thread, in file order.
+  size_t next_thread = 0;
+  for (size_t p = 0; p < header->num_processes; p++) {
+    const FileProcess& in = processes[p];
+    if (in.pid < 0 || in.type > Process::BATCH
+        || in.first_thread != next_thread
+        || in.num_threads > header->num_threads - next_thread) {
+      fail(filename, "process " + to_string(p) + " is invalid");
+    }
+
+    ProcessSpec& out = workload.processes[p];
+    out.pid = in.pid;
+    out.type = (Process::Type) in.type;
+    out.first_thread = in.first_thread;
+    out.num_threads = in.num_threads;
+    next_thread += in.num_threads;
+  }
+
+  size_t next_burst = 0;
+  for (size_t t = 0; t < header->num_threads; t++) {
+    const FileThread& in = threads[t];
+    const ProcessSpec* process = in.process < workload.processes.size()
+        ? &workload.processes[in.process] : nullptr;
+    if (process == nullptr || t < process->first_thread
+        || t >= process->first_thread + process->num_threads
+        || in.arrival_time < 0 || in.num_bursts % 2 == 0
+        || in.first_burst != next_burst
+        || in.num_bursts > header->num_bursts - next_burst) {
+      fail(filename, "thread " + to_string(t) + " is invalid");
+    }
+
+    ThreadSpec& out = workload.threads[t];
+    out.id = in.id;
+    out.arrival_time = in.arrival_time;
+    out.process = in.process;
+    out.first_burst = in.first_burst;
+    out.num_bursts = in.num_bursts;
+    next_burst += in.num_bursts;
+  }
+
+  if (next_thread != header->num_threads || next_burst != header->num_bursts) {
+    fail(filename, "tables contain unreferenced entries");
+  }
+
+  return workload;
+}
+
+
+bool write_binary_workload(const string& filename, const Workload& workload,
+                           uint64_t source_hash) {
+  BinaryWorkloadWriter writer(filename, workload.thread_switch_overhead,
+                              workload.process_switch_overhead, source_hash);
+  return writer.is_open() && writer.append(workload) && writer.finish();
+}
+
+
+BinaryWorkloadWriter::BinaryWorkloadWriter(const string& filename,
+                                           size_t thread_switch_overhead,
+                                           size_t process_switch_overhead,
+                                           uint64_t source_hash)
+    : filename(filename),
+      thread_switch_overhead(thread_switch_overhead),
+      process_switch_overhead(process_switch_overhead),
+      source_hash(source_hash) {
+  output = fopen((filename + ".tmp").c_str(), "w+b");
+  threads = tmpfile();
+  bursts = tmpfile();
+
+  // leave room for the header, which is written last
+  FileHeader header = FileHeader();
+  ok = is_open() && fwrite(&header, sizeof(header), 1, output) == 1;
+}
+
+
+BinaryWorkloadWriter::~BinaryWorkloadWriter() {
+  if (threads != nullptr) fclose(threads);
+  if (bursts != nullptr) fclose(bursts);
+  if (output != nullptr) {
+    fclose(output);
+    remove((filename + ".tmp").c_str());
+  }
+}
+
+
+bool BinaryWorkloadWriter::is_open() const {
+  return output != nullptr && threads != nullptr && bursts != nullptr;
+}
+
+
+bool BinaryWorkloadWriter::append(const Workload& part) {
+  if (!ok) return false;
+
+  vector<FileProcess> process_records(part.processes.size());
+  for (size_t p = 0; p < process_records.size(); p++) {
+    const ProcessSpec& in = part.processes[p];
+    process_records[p] = {in.pid, (uint32_t) in.type,
+                          (uint32_t) (num_threads + in.first_thread),
+                          (uint32_t) in.num_threads};
+  }
+
+  vector<FileThread> thread_records(part.threads.size());
+  for (size_t t = 0; t < thread_records.size(); t++) {
+    const ThreadSpec& in = part.threads[t];
+    thread_records[t] = {in.id, in.arrival_time,
+                         (uint32_t) (num_processes + in.process),
+                         (uint32_t) in.num_bursts,
+                         num_bursts + in.first_burst};
+  }
+
+  ok = fwrite(process_records.data(), sizeof(FileProcess),
+              process_records.size(), output) == process_records.size()
+      && fwrite(thread_records.data(), sizeof(FileThread),
+                thread_records.size(), threads) == thread_records.size()
+      && fwrite(part.bursts.data(), sizeof(int32_t), part.bursts.size(),
+                bursts) == part.bursts.size();
+
+  num_processes += part.processes.size();
+  num_threads += part.threads.size();
+  num_bursts += part.bursts.size();
+  return ok;
+}
+
+
+// copies the rest of `from`, starting at its beginning, onto the end of `to`
+static bool append_file(FILE* from, FILE* to) {
+  if (fflush(from) != 0 || fseek(from, 0, SEEK_SET) != 0) return false;
+
+  vector<char> buffer(1 << 20);
+  size_t length;
+  while ((length = fread(buffer.data(), 1, buffer.size(), from)) > 0) {
+    if (fwrite(buffer.data(), 1, length, to) != length) return false;
+  }
+  return !ferror(from);
+}
+
+
+bool BinaryWorkloadWriter::finish() {
+  FileHeader header;
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = BINARY_WORKLOAD_VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.source_hash = source_hash;
+  header.thread_switch_overhead = thread_switch_overhead;
+  header.process_switch_overhead = process_switch_overhead;
+  header.num_processes = num_processes;
+  header.num_threads = num_threads;
+  header.num_bursts = num_bursts;
+
+  ok = ok && append_file(threads, output) && append_file(bursts, output)
+      && fseek(output, 0, SEEK_SET) == 0
+      && fwrite(&header, sizeof(header), 1, output) == 1;
+
+  string temporary = filename + ".tmp";
+  ok = (fclose(output) == 0) && ok
+      && rename(temporary.c_str(), filename.c_str()) == 0;
+  output = nullptr;
+
+  if (!ok) remove(temporary.c_str());
+  return ok;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "types/workload.h"
+#include "util/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+
+/**
+ * The version of the binary workload format written by this program. Files
+ * with any other version are rejected.
+ */
+extern const uint32_t BINARY_WORKLOAD_VERSION;
+
+
+/**
+ * Returns the FNV-1a hash of the given bytes. Binary workloads record the hash
+ * of the text file they were converted from, so that a cached conversion can
+ * be checked against its source.
+ */
+uint64_t hash_bytes(const char* data, size_t size);
+
+
+/**
+ * Returns true if the mapped file starts with the binary workload magic
+ * number, whatever its version.
+ */
+bool is_binary_workload(const MappedFile& file);
+
+
+/**
+ * Reads the hash of the source text file from the header of a binary
+ * workload. Returns false if the file is not a binary workload of the current
+ * version written on a machine with the same byte order.
+ */
+bool read_binary_source_hash(const MappedFile& file, uint64_t& source_hash);
+
+
+/**
+ * Decodes a binary workload. Each table is copied out of the mapping in a
+ * single allocation. Exits with an error naming `filename` if the file is
+ * truncated or inconsistent.
+ */
+Workload read_binary_workload(const MappedFile& file,
+                              const std::string& filename);
+
+
+/**
+ * Writes the workload in binary form, tagged with the hash of the text file it
+ * was read from. The file is written under a temporary name and renamed into
+ * place, so readers never see a partial file. Returns false on failure.
+ */
+bool write_binary_workload(const std::string& filename,
+                           const Workload& workload,
+                           uint64_t source_hash);
+
+
+/**
+ * Writes a binary workload piece by piece, for workloads too large to hold in
+ * memory at once. The thread and burst tables are spooled to temporary files
+ * until finish() is called, since their sizes are only known at the end.
+ */
+class BinaryWorkloadWriter {
+public:
+
+  /**
+   * Starts writing a workload with the given overheads. Check is_open() to
+   * see if the output could be created.
+   */
+  BinaryWorkloadWriter(const std::string& filename,
+                       size_t thread_switch_overhead,
+                       size_t process_switch_overhead,
+                       uint64_t source_hash);
+
+  /**
+   * Discards the output if finish() was never called successfully.
+   */
+  ~BinaryWorkloadWriter();
+
+  BinaryWorkloadWriter(const BinaryWorkloadWriter&) = delete;
+  BinaryWorkloadWriter& operator=(const BinaryWorkloadWriter&) = delete;
+
+  /**
+   * Returns true if the output and temporary files were created.
+   */
+  bool is_open() const;
+
+  /**
+   * Appends the processes, threads and bursts of `part`, whose indices are
+   * relative to `part` itself. Its overheads are ignored.
+   */
+  bool append(const Workload& part);
+
+  /**
+   * Writes the header and tables and moves the file into place. Returns false
+   * if any write failed.
+   */
+  bool finish();
+
+private:
+
+  /**
+   * The name that the finished file is renamed to.
+   */
+  std::string filename;
+
+  /**
+   * The file being written, which holds the header and process table.
+   */
+  FILE* output = nullptr;
+
+  /**
+   * Spooled thread table.
+   */
+  FILE* threads = nullptr;
+
+  /**
+   * Spooled burst table.
+   */
+  FILE* bursts = nullptr;
+
+  /**
+   * The overheads and source hash to write in the header.
+   */
+  size_t thread_switch_overhead;
+  size_t process_switch_overhead;
+  uint64_t source_hash;
+
+  /**
+   * The number of entries appended to each table so far.
+   */
+  size_t num_processes = 0;
+  size_t num_threads = 0;
+  size_t num_bursts = 0;
+
+  /**
+   * Cleared by the first failed write.
+   */
+  bool ok = true;
+};
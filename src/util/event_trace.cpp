@@ -0,0 +1,79 @@
+#include "util/event_trace.h"
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+
+/**
+ * The first eight bytes of every trace file.
+ */
+static const char MAGIC[8] = {'S', 'I', 'M', 'T', 'R', 'A', 'C', 'E'};
+
+
+/**
+ * The version of the trace format, bumped whenever TraceRecord changes.
+ */
+static const uint32_t TRACE_VERSION = 1;
+
+
+/**
+ * Precedes the records in a trace file.
+ */
+struct TraceHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+};
+
+static_assert(sizeof(TraceRecord) == 16, "unexpected trace record padding");
+static_assert(sizeof(TraceHeader) == 16, "unexpected trace header padding");
+
+
+EventTraceWriter::EventTraceWriter(const string& filename) {
+  fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    cerr << "Unable to create trace file: " << filename << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  writer.reset(new TraceWriter(fd));
+
+  TraceHeader header;
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = TRACE_VERSION;
+  header.record_size = sizeof(TraceRecord);
+  writer->append(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+
+EventTraceWriter::~EventTraceWriter() {
+  // the writer must finish with the file before it is closed
+  writer.reset();
+  close(fd);
+}
+
+
+EventTraceReader::EventTraceReader(const string& filename) : file(filename) {
+  if (!file.is_open()) {
+    cerr << "Unable to open trace file: " << filename << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  const TraceHeader* header = reinterpret_cast<const TraceHeader*>(file.data());
+  if (file.size() < sizeof(TraceHeader)
+      || memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+      || header->version != TRACE_VERSION
+      || header->record_size != sizeof(TraceRecord)
+      || (file.size() - sizeof(TraceHeader)) % sizeof(TraceRecord) != 0) {
+    cerr << filename << ": not a trace file of version " << TRACE_VERSION
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  records = reinterpret_cast<const TraceRecord*>(header + 1);
+  count = (file.size() - sizeof(TraceHeader)) / sizeof(TraceRecord);
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "types/event.h"
+#include "util/mapped_file.h"
+#include "util/trace_writer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+/**
+ * One handled event in a binary event trace. Every record has the same
+ * 16-byte layout, so a trace is just a header followed by an array of these.
+ * A DISPATCHER_INVOKED record that chose a thread is followed by a DECISION
+ * record holding the rest of the decision, which keeps the far more common
+ * records small.
+ */
+struct TraceRecord {
+  /**
+   * Marks a field that does not apply to the record.
+   */
+  static const uint8_t NONE = 0xFF;
+
+  /**
+   * The type of the record that follows a DISPATCHER_INVOKED record.
+   */
+  static const uint8_t DECISION = 0xFE;
+
+  /**
+   * The time at which the event happened.
+   */
+  int32_t time;
+
+  /**
+   * The Event::Type of the event, or DECISION.
+   */
+  uint8_t type;
+
+  /**
+   * The Thread::State of the thread before and after the event was handled,
+   * or NONE if the event has no thread.
+   */
+  uint8_t old_state;
+  uint8_t new_state;
+
+  /**
+   * For DISPATCHER_INVOKED, the queue or level that the chosen thread was
+   * taken from, or NONE if the scheduler has no levels.
+   */
+  uint8_t level;
+
+  union {
+    /**
+     * The PID and thread ID of the thread, or -1 if the event has no thread.
+     * For DISPATCHER_INVOKED, this is the thread that was chosen.
+     */
+    struct {
+      int32_t pid;
+      int32_t tid;
+    } thread;
+
+    /**
+     * For DECISION, the time slice that was granted, or -1 if the thread may
+     * run to the end of its burst, and the number of threads that the
+     * decision chose between.
+     */
+    struct {
+      int32_t time_slice;
+      uint32_t candidates;
+    } decision;
+  };
+};
+
+
+/**
+ * Records handled events to a binary trace file. Records are copied into
+ * large buffers that a background thread writes out, so recording an event
+ * costs little more than the copy.
+ */
+class EventTraceWriter {
+public:
+
+  /**
+   * Creates the file and writes its header, exiting if the file cannot be
+   * created.
+   */
+  explicit EventTraceWriter(const std::string& filename);
+
+  /**
+   * Writes any buffered records and closes the file.
+   */
+  ~EventTraceWriter();
+
+  EventTraceWriter(const EventTraceWriter&) = delete;
+  EventTraceWriter& operator=(const EventTraceWriter&) = delete;
+
+  /**
+   * Appends a record.
+   */
+  void record(const TraceRecord& record) {
+    writer->append(reinterpret_cast<const char*>(&record), sizeof(record));
+  }
+
+  /**
+   * Blocks until every record so far is in the file.
+   */
+  void flush() { writer->flush(); }
+
+private:
+
+  /**
+   * The open trace file.
+   */
+  int fd;
+
+  /**
+   * Buffers records and writes them to `fd`.
+   */
+  std::unique_ptr<TraceWriter> writer;
+};
+
+
+/**
+ * A read-only view of a binary trace file.
+ */
+class EventTraceReader {
+public:
+
+  /**
+   * Maps the file into memory, exiting with an error if it is not a trace
+   * written by this version of the program.
+   */
+  explicit EventTraceReader(const std::string& filename);
+
+  /**
+   * Returns the records in the order the events were handled.
+   */
+  const TraceRecord* begin() const { return records; }
+  const TraceRecord* end() const { return records + count; }
+
+  /**
+   * Returns the number of records.
+   */
+  size_t size() const { return count; }
+
+private:
+
+  /**
+   * The mapped file.
+   */
+  MappedFile file;
+
+  /**
+   * The first record in the mapping, and the number of records.
+   */
+  const TraceRecord* records = nullptr;
+  size_t count = 0;
+};
@@ -1,9 +1,18 @@
 #include "flags.h"
+#include "algorithms/cfs_scheduler.h"
 #include "algorithms/fcfs_scheduler.h"
 #include "algorithms/multilevel_feedback_scheduler.h"
 #include "algorithms/priority_scheduler.h"
 #include "algorithms/round_robin_scheduler.h"
+#include "algorithms/spn_scheduler.h"
+#include "algorithms/srtf_scheduler.h"
+#include "event_queues/binary_heap_event_queue.h"
+#include "event_queues/calendar_event_queue.h"
+#include "types/workload.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <cstdio>
 #include <cstdlib>
 #include <getopt.h>
 #include <fstream>
@@ -11,9 +20,77 @@
 using namespace std;
 
 
+const vector<string> SCHEDULER_NAMES = {"FCFS", "RR", "PRIORITY", "MLFQ", "SRTF", "SPN", "CFS"};
+
+
+const vector<string> EVENT_QUEUE_NAMES = {"CALENDAR", "HEAP"};
+
+
+const vector<string> PARSER_NAMES = {"MMAP", "ISTREAM"};
+
+
+const vector<string> EXPORT_FORMAT_NAMES = {"CHROME", "GANTT"};
+
+
+// returns true if the name appears in the list of valid names
+static bool is_valid(const vector<string>& names, const string& name) {
+  return find(names.begin(), names.end(), name) != names.end();
+}
+
+
+// parses a whole non-negative integer, exiting on failure
+static size_t parse_count(const char* text) {
+  char* end;
+  unsigned long long value = strtoull(text, &end, 10);
+  if (!isdigit(text[0]) || *end != '\0') {
+    cerr << "Invalid number: " << text << endl;
+    exit(EXIT_FAILURE);
+  }
+  return value;
+}
+
+
+// parses a dispatch overhead, exiting if it is malformed or larger than the
+// simulator accepts
+static size_t parse_overhead(const char* text) {
+  size_t value = parse_count(text);
+  if (value > MAX_SWITCH_OVERHEAD) {
+    cerr << "Switch overheads must be at most " << MAX_SWITCH_OVERHEAD
+         << ", since they are added to the simulated time on every dispatch: "
+         << text << endl;
+    exit(EXIT_FAILURE);
+  }
+  return value;
+}
+
+
+// parses a positive real number, exiting on failure
+static double parse_positive(const char* text) {
+  char* end;
+  double value = strtod(text, &end);
+  if (end == text || *end != '\0' || !(value > 0)) {
+    cerr << "Invalid positive number: " << text << endl;
+    exit(EXIT_FAILURE);
+  }
+  return value;
+}
+
+
 void print_usage() {
   cout <<
-      "Usage: sim [-dvh] filename\n"
+      "Usage: sim [-tvscmbPCNFQh] [-a algorithm] [-e event_queue] [-p parser]\n"
+      "           [-A alpha] [-G guess] [-L latency] [-M granularity]\n"
+      "           [-T trace] [-w range]... filename\n"
+      "       sim convert [-p parser] filename output\n"
+      "       sim generate [options] output\n"
+      "       sim bench [options] baseline\n"
+      "       sim microbench [options]\n"
+      "       sim export [-f format] trace\n"
+      "\n"
+      "The simulation file may be a text file or a binary workload written by\n"
+      "'sim convert' or 'sim generate'. Binary workloads cannot be used with\n"
+      "--stream. Run 'sim <command> -h' for the options of the generate, bench,\n"
+      "microbench and export commands.\n"
       "\n"
       "Options:\n"
       "  -h, --help:\n"
@@ -22,12 +99,71 @@ void print_usage() {
       "      If set, outputs per-thread metrics at the end of the simulation.\n"
       "  -v, --verbose:\n"
       "      If set, outputs all state transitions and scheduling choices.\n"
+      "  -s, --engine_stats:\n"
+      "      If set, outputs statistics about the simulator itself.\n"
       "  -a, --algorithm <algorithm>:\n"
       "      The scheduling algorithm to use. Valid values are:\n"
       "        FCFS: first-come, first-served (default)\n"
       "        RR: round-robin scheduling\n"
       "        PRIORITY: priority scheduling\n"
-      "        MLFQ: multilevel feedback queue\n";
+      "        MLFQ: multilevel feedback queue\n"
+      "        SRTF: shortest remaining time first, preemptive\n"
+      "        SPN: shortest process next, by predicted burst length\n"
+      "        CFS: completely fair, by virtual runtime weighted by type\n"
+      "  -A, --alpha <weight>:\n"
+      "      How much SPN's prediction of a thread's next burst follows its\n"
+      "      latest burst rather than its earlier ones, from 0 (exclusive) to\n"
+      "      1 (default 0.5).\n"
+      "  -G, --initial_guess <ticks>:\n"
+      "      The length SPN predicts for a thread's first burst (default 10).\n"
+      "  -L, --target_latency <ticks>:\n"
+      "      The period in which CFS tries to give every ready thread a turn,\n"
+      "      split between them by weight (default 24).\n"
+      "  -M, --min_granularity <ticks>:\n"
+      "      The shortest time slice CFS gives a thread (default 3).\n"
+      "  -e, --event_queue <queue>:\n"
+      "      The data structure that holds pending events. Valid values are:\n"
+      "        CALENDAR: calendar queue, amortized O(1) (default)\n"
+      "        HEAP: binary heap, O(log n)\n"
+      "  -c, --compare:\n"
+      "      Runs every scheduling algorithm on the same workload in parallel\n"
+      "      and prints their statistics side by side.\n"
+      "  -w, --sweep <name>=<first>..<last>[:<step>]:\n"
+      "      Simulates every combination of the given parameter ranges in\n"
+      "      parallel and prints one CSV row per combination. May be repeated.\n"
+      "      Valid names are quantum, thread_switch and process_switch; the\n"
+      "      switch overheads may be at most 1000000. With --compare, every\n"
+      "      algorithm is included in the sweep.\n"
+      "  -m, --stream:\n"
+      "      Reads threads just before they arrive and frees them once they\n"
+      "      exit, so memory use is bounded by the number of live threads.\n"
+      "      The file must be sorted by arrival time. Per-thread metrics are\n"
+      "      not available in this mode.\n"
+      "  -b, --background_parse:\n"
+      "      Like --stream, but parses the file on a separate thread.\n"
+      "  -p, --parser <parser>:\n"
+      "      How the simulation file is read. Valid values are:\n"
+      "        MMAP: memory-maps the file and scans it by hand (default)\n"
+      "        ISTREAM: reads the file with std::ifstream\n"
+      "  -P, --parse_only:\n"
+      "      Parses the file, prints how long that took, and exits.\n"
+      "  -C, --cache:\n"
+      "      Converts a text simulation file to '<filename>.simbin' the first\n"
+      "      time it is read, and loads that instead while the text file is\n"
+      "      unchanged.\n"
+      "  -T, --trace <file>:\n"
+      "      Records every handled event to the given file in a compact binary\n"
+      "      form, which 'sim export' turns into other formats.\n"
+      "  -N, --no_fast_forward:\n"
+      "      Simulates every time slice of a thread that has the CPU to itself,\n"
+      "      instead of skipping to the last one.\n"
+      "  -F, --verify_fast_forward:\n"
+      "      Simulates the workload with and without fast-forwarding, checks\n"
+      "      that every statistic and thread ends up the same, and exits.\n"
+      "  -Q, --queued_dispatch:\n"
+      "      Puts every dispatcher invocation on the event queue as an event of\n"
+      "      its own, instead of running the dispatcher as soon as the events\n"
+      "      that asked for it have been handled.\n";
 }
 
 
@@ -38,7 +174,24 @@ FlagOptions parse_flags(int argc, char** argv) {
   static struct option flag_options[] = {
     {"per_thread", no_argument,       0, 't'},
     {"verbose",    no_argument,       0, 'v'},
+    {"engine_stats", no_argument,     0, 's'},
     {"algorithm",  required_argument, 0, 'a'},
+    {"alpha",      required_argument, 0, 'A'},
+    {"initial_guess", required_argument, 0, 'G'},
+    {"target_latency", required_argument, 0, 'L'},
+    {"min_granularity", required_argument, 0, 'M'},
+    {"event_queue", required_argument, 0, 'e'},
+    {"compare",    no_argument,       0, 'c'},
+    {"sweep",      required_argument, 0, 'w'},
+    {"stream",     no_argument,       0, 'm'},
+    {"background_parse", no_argument, 0, 'b'},
+    {"parser",     required_argument, 0, 'p'},
+    {"parse_only", no_argument,       0, 'P'},
+    {"cache",      no_argument,       0, 'C'},
+    {"trace",      required_argument, 0, 'T'},
+    {"no_fast_forward", no_argument,  0, 'N'},
+    {"verify_fast_forward", no_argument, 0, 'F'},
+    {"queued_dispatch", no_argument,  0, 'Q'},
     {"help",       no_argument,       0, 'h'},
     {0, 0, 0, 0}
   };
@@ -48,7 +201,7 @@ FlagOptions parse_flags(int argc, char** argv) {
 
   // Parse flags entered by the user.
   while (true) {
-    flag_char = getopt_long(argc, argv, "-tvha:", flag_options, &option_index);
+    flag_char = getopt_long(argc, argv, "-tvscmbPCNFQha:A:G:L:M:e:w:p:T:", flag_options, &option_index);
 
     // Detect the end of the options.
     if (flag_char == -1) {
@@ -64,17 +217,134 @@ FlagOptions parse_flags(int argc, char** argv) {
         flags.verbose = true;
         break;
 
+      case 's':
+        flags.engine_stats = true;
+        break;
+
       case 'a':
-        flags.scheduler = instantiate_scheduler();
+        flags.algorithm = optarg;
+        if (!is_valid(SCHEDULER_NAMES, flags.algorithm)) {
+          print_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'A':
+        flags.scheduler.alpha = parse_positive(optarg);
+        if (flags.scheduler.alpha > 1) {
+          cerr << "Alpha must be at most 1: " << optarg << endl;
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'G':
+        flags.scheduler.initial_guess = parse_positive(optarg);
+        break;
+
+      case 'L':
+        flags.scheduler.target_latency = parse_count(optarg);
+        if (flags.scheduler.target_latency == 0) {
+          cerr << "Target latency must be positive: " << optarg << endl;
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'M':
+        flags.scheduler.min_granularity = parse_count(optarg);
+        if (flags.scheduler.min_granularity == 0) {
+          cerr << "Minimum granularity must be positive: " << optarg << endl;
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'e':
+        flags.event_queue = optarg;
+        if (!is_valid(EVENT_QUEUE_NAMES, flags.event_queue)) {
+          print_usage();
+          exit(EXIT_FAILURE);
+        }
         break;
 
+      case 'c':
+        flags.compare = true;
+        break;
+
+      case 'm':
+        flags.stream = true;
+        break;
+
+      case 'b':
+        flags.stream = true;
+        flags.background_parse = true;
+        break;
+
+      case 'p':
+        flags.parser = optarg;
+        if (!is_valid(PARSER_NAMES, flags.parser)) {
+          print_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'P':
+        flags.parse_only = true;
+        break;
+
+      case 'C':
+        flags.cache = true;
+        break;
+
+      case 'T':
+        flags.trace = optarg;
+        break;
+
+      case 'N':
+        flags.fast_forward = false;
+        break;
+
+      case 'F':
+        flags.verify_fast_forward = true;
+        break;
+
+      case 'Q':
+        flags.fused_dispatch = false;
+        break;
+
+      case 'w': {
+        SweepRange range;
+        if (!parse_sweep_range(optarg, range)) {
+          cerr << "Invalid sweep range: " << optarg << endl;
+          print_usage();
+          exit(EXIT_FAILURE);
+        }
+        if (range.parameter != "quantum" && range.last > MAX_SWITCH_OVERHEAD) {
+          cerr << "Switch overheads must be at most " << MAX_SWITCH_OVERHEAD
+               << ", since they are added to the simulated time on every "
+                  "dispatch: " << optarg << endl;
+          exit(EXIT_FAILURE);
+        }
+        flags.sweep.push_back(range);
+        break;
+      }
+
       case 'h':
         print_usage();
         exit(EXIT_SUCCESS);
         break;
 
+      // positional arguments: an optional "convert" command, the input file
+      // and, when converting, the output file
       case 1:
-        flags.filename = optarg;
+        if (!flags.convert && flags.filename == "" && string(optarg) == "convert") {
+          flags.convert = true;
+        } else if (flags.filename == "") {
+          flags.filename = optarg;
+        } else if (flags.convert && flags.output == "") {
+          flags.output = optarg;
+        } else {
+          print_usage();
+          exit(EXIT_FAILURE);
+        }
         break;
 
       default:
@@ -83,35 +353,603 @@ FlagOptions parse_flags(int argc, char** argv) {
     }
   }
 
-  if (flags.filename == "") {
+  if (flags.filename == "" || (flags.convert && flags.output == "")) {
     print_usage();
     exit(EXIT_FAILURE);
   }
 
-  if (flags.scheduler == nullptr) {
-    flags.scheduler = new FcfsScheduler();
+  // comparisons and sweeps need the whole workload in memory
+  if (flags.stream && (flags.compare || !flags.sweep.empty())) {
+    cerr << "--stream cannot be combined with --compare or --sweep" << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // a trace records a single simulation
+  if (flags.trace != "" && (flags.compare || !flags.sweep.empty())) {
+    cerr << "--trace cannot be combined with --compare or --sweep" << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // the check compares two simulations of the whole workload
+  if (flags.verify_fast_forward
+      && (flags.stream || flags.compare || !flags.sweep.empty()
+          || flags.trace != "")) {
+    cerr << "--verify_fast_forward cannot be combined with --stream, "
+            "--compare, --sweep or --trace" << endl;
+    exit(EXIT_FAILURE);
   }
 
   return flags;
 }
 
 
-Scheduler* instantiate_scheduler() {
-  Scheduler* scheduler;
-  string option(optarg);
+void print_generator_usage() {
+  cout <<
+      "Usage: sim generate [-Bh] [-s seed] [-n processes] [-T threads]\n"
+      "           [-m mix] [-a arrivals] [-i interarrival] [-d period]\n"
+      "           [-c cpu_bursts] [-l distribution] [-L burst_length]\n"
+      "           [-r io_ratio] [-t thread_switch] [-p process_switch]\n"
+      "           [-j jobs] output\n"
+      "\n"
+      "Writes a random workload. The same options always produce the same file.\n"
+      "\n"
+      "Options:\n"
+      "  -h, --help:\n"
+      "      Print this help message and exit.\n"
+      "  -B, --binary:\n"
+      "      Write the binary format instead of text.\n"
+      "  -s, --seed <seed>:\n"
+      "      Seeds every random choice (default 1).\n"
+      "  -n, --processes <count>:\n"
+      "      The number of processes (default 1000).\n"
+      "  -T, --threads <min>..<max>:\n"
+      "      The range of threads per process, drawn uniformly (default 1..4).\n"
+      "  -m, --mix <system>,<interactive>,<normal>,<batch>:\n"
+      "      Relative weights of the process types (default 1,2,4,1).\n"
+      "  -a, --arrivals <process>:\n"
+      "      How thread arrivals are spread over time. Valid values are:\n"
+      "        POISSON: exponential interarrival times (default)\n"
+      "        BURSTY: alternating bursts and lulls\n"
+      "        DIURNAL: a rate that rises and falls once per period\n"
+      "  -i, --interarrival <mean>:\n"
+      "      The mean time between thread arrivals (default 5).\n"
+      "  -d, --period <length>:\n"
+      "      The length of one DIURNAL cycle (default 10000).\n"
+      "  -c, --cpu_bursts <mean>:\n"
+      "      The mean number of CPU bursts per thread (default 3).\n"
+      "  -l, --distribution <distribution>:\n"
+      "      The distribution of burst lengths. Valid values are:\n"
+      "        EXPONENTIAL (default), UNIFORM, PARETO\n"
+      "  -L, --burst_length <mean>:\n"
+      "      The mean length of a CPU burst (default 15).\n"
+      "  -r, --io_ratio <ratio>:\n"
+      "      The mean IO burst length as a multiple of the mean CPU burst\n"
+      "      length (default 1.5).\n"
+      "  -t, --thread_switch <overhead>:\n"
+      "      The thread switch overhead written to the file (default 3).\n"
+      "  -p, --process_switch <overhead>:\n"
+      "      The process switch overhead written to the file (default 7).\n"
+      "  -j, --jobs <count>:\n"
+      "      The number of worker threads (default: one per hardware thread).\n";
+}
+
+
+GeneratorOptions parse_generator_flags(int argc, char** argv) {
+  GeneratorOptions options;
 
-  if (option == "FCFS") {
+  static struct option generator_options[] = {
+    {"binary",       no_argument,       0, 'B'},
+    {"seed",         required_argument, 0, 's'},
+    {"processes",    required_argument, 0, 'n'},
+    {"threads",      required_argument, 0, 'T'},
+    {"mix",          required_argument, 0, 'm'},
+    {"arrivals",     required_argument, 0, 'a'},
+    {"interarrival", required_argument, 0, 'i'},
+    {"period",       required_argument, 0, 'd'},
+    {"cpu_bursts",   required_argument, 0, 'c'},
+    {"distribution", required_argument, 0, 'l'},
+    {"burst_length", required_argument, 0, 'L'},
+    {"io_ratio",     required_argument, 0, 'r'},
+    {"thread_switch", required_argument, 0, 't'},
+    {"process_switch", required_argument, 0, 'p'},
+    {"jobs",         required_argument, 0, 'j'},
+    {"help",         no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+  };
+
+  int option_index;
+  char flag_char;
+
+  while (true) {
+    flag_char = getopt_long(argc, argv, "-Bhs:n:T:m:a:i:d:c:l:L:r:t:p:j:",
+                            generator_options, &option_index);
+
+    if (flag_char == -1) {
+      break;
+    }
+
+    switch (flag_char) {
+      case 'B':
+        options.binary = true;
+        break;
+
+      case 's':
+        options.seed = parse_count(optarg);
+        break;
+
+      case 'n':
+        options.num_processes = parse_count(optarg);
+        break;
+
+      case 'T': {
+        unsigned long min, max;
+        int consumed = 0;
+        if (sscanf(optarg, "%lu..%lu%n", &min, &max, &consumed) != 2
+            || optarg[consumed] != '\0' || min > max) {
+          cerr << "Invalid thread range: " << optarg << endl;
+          print_generator_usage();
+          exit(EXIT_FAILURE);
+        }
+        options.min_threads = min;
+        options.max_threads = max;
+        break;
+      }
+
+      case 'm': {
+        double weights[4];
+        int consumed = 0;
+        if (sscanf(optarg, "%lf,%lf,%lf,%lf%n", &weights[0], &weights[1],
+                   &weights[2], &weights[3], &consumed) != 4
+            || optarg[consumed] != '\0'
+            || !(weights[0] >= 0 && weights[1] >= 0 && weights[2] >= 0
+                 && weights[3] >= 0)
+            || weights[0] + weights[1] + weights[2] + weights[3] <= 0) {
+          cerr << "Invalid process type mix: " << optarg << endl;
+          print_generator_usage();
+          exit(EXIT_FAILURE);
+        }
+        options.type_mix.assign(weights, weights + 4);
+        break;
+      }
+
+      case 'a':
+        options.arrivals = optarg;
+        if (!is_valid(ARRIVAL_PROCESS_NAMES, options.arrivals)) {
+          print_generator_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'i':
+        options.mean_interarrival = parse_positive(optarg);
+        break;
+
+      case 'd':
+        options.period = parse_positive(optarg);
+        break;
+
+      case 'c':
+        options.mean_cpu_bursts = parse_positive(optarg);
+        if (options.mean_cpu_bursts < 1) {
+          cerr << "Threads have at least one CPU burst" << endl;
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'l':
+        options.burst_distribution = optarg;
+        if (!is_valid(BURST_DISTRIBUTION_NAMES, options.burst_distribution)) {
+          print_generator_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'L':
+        options.mean_cpu_burst = parse_positive(optarg);
+        break;
+
+      case 'r':
+        options.io_ratio = parse_positive(optarg);
+        break;
+
+      case 't':
+        options.thread_switch_overhead = parse_overhead(optarg);
+        break;
+
+      case 'p':
+        options.process_switch_overhead = parse_overhead(optarg);
+        break;
+
+      case 'j':
+        options.jobs = parse_count(optarg);
+        break;
+
+      case 'h':
+        print_generator_usage();
+        exit(EXIT_SUCCESS);
+        break;
+
+      case 1:
+        if (options.output != "") {
+          print_generator_usage();
+          exit(EXIT_FAILURE);
+        }
+        options.output = optarg;
+        break;
+
+      default:
+        print_generator_usage();
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (options.output == "") {
+    print_generator_usage();
+    exit(EXIT_FAILURE);
+  }
+
+  return options;
+}
+
+
+void print_benchmark_usage() {
+  cout <<
+      "Usage: sim bench [-uh] [-r repeats] [-x tolerance] [-d corpus]\n"
+      "           [-e event_queue] baseline\n"
+      "\n"
+      "Runs every scheduling algorithm over a fixed corpus of generated\n"
+      "workloads, each run in a separate process, and compares the results\n"
+      "with the baseline file. Exits with an error status if any run\n"
+      "simulates a different number of events, or uses more allocations or\n"
+      "memory than its baseline allows. A run that is slower than its\n"
+      "baseline allows is only warned about, since its speed depends on what\n"
+      "else the machine is doing.\n"
+      "\n"
+      "Options:\n"
+      "  -h, --help:\n"
+      "      Print this help message and exit.\n"
+      "  -u, --update:\n"
+      "      Write the results to the baseline file instead of comparing.\n"
+      "  -r, --repeats <count>:\n"
+      "      Runs each benchmark this many times and keeps the median\n"
+      "      (default 5).\n"
+      "  -x, --tolerance <percent>:\n"
+      "      How much slower, or how much more memory, than the baseline a\n"
+      "      result may take before it is flagged (default 30).\n"
+      "  -d, --corpus <directory>:\n"
+      "      Where the generated workloads are kept (default bench/corpus).\n"
+      "  -e, --event_queue <queue>:\n"
+      "      The event queue to use, as for the simulator (default CALENDAR).\n";
+}
+
+
+BenchmarkOptions parse_benchmark_flags(int argc, char** argv) {
+  BenchmarkOptions options;
+
+  static struct option benchmark_options[] = {
+    {"update",      no_argument,       0, 'u'},
+    {"repeats",     required_argument, 0, 'r'},
+    {"tolerance",   required_argument, 0, 'x'},
+    {"corpus",      required_argument, 0, 'd'},
+    {"event_queue", required_argument, 0, 'e'},
+    {"help",        no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+  };
+
+  int option_index;
+  char flag_char;
+
+  while (true) {
+    flag_char = getopt_long(argc, argv, "-uhr:x:d:e:", benchmark_options,
+                            &option_index);
+
+    if (flag_char == -1) {
+      break;
+    }
+
+    switch (flag_char) {
+      case 'u':
+        options.update = true;
+        break;
+
+      case 'r':
+        options.repeats = parse_count(optarg);
+        if (options.repeats == 0) {
+          print_benchmark_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'x':
+        options.tolerance = parse_positive(optarg) / 100;
+        break;
+
+      case 'd':
+        options.corpus = optarg;
+        break;
+
+      case 'e':
+        options.event_queue = optarg;
+        if (!is_valid(EVENT_QUEUE_NAMES, options.event_queue)) {
+          print_benchmark_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'h':
+        print_benchmark_usage();
+        exit(EXIT_SUCCESS);
+        break;
+
+      case 1:
+        if (options.baseline != "") {
+          print_benchmark_usage();
+          exit(EXIT_FAILURE);
+        }
+        options.baseline = optarg;
+        break;
+
+      default:
+        print_benchmark_usage();
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (options.baseline == "") {
+    print_benchmark_usage();
+    exit(EXIT_FAILURE);
+  }
+
+  return options;
+}
+
+
+void print_export_usage() {
+  cout <<
+      "Usage: sim export [-h] [-f format] trace\n"
+      "\n"
+      "Converts a trace written with --trace into a text format on stdout.\n"
+      "\n"
+      "Options:\n"
+      "  -h, --help:\n"
+      "      Print this help message and exit.\n"
+      "  -f, --format <format>:\n"
+      "      The format to write. Valid values are:\n"
+      "        CHROME: Chrome trace-event JSON, with one track per thread\n"
+      "                (default)\n"
+      "        GANTT: CSV with one row per span of time a thread spent in\n"
+      "               one state\n";
+}
+
+
+ExportOptions parse_export_flags(int argc, char** argv) {
+  ExportOptions options;
+
+  static struct option export_options[] = {
+    {"format", required_argument, 0, 'f'},
+    {"help",   no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+  };
+
+  int option_index;
+  char flag_char;
+
+  while (true) {
+    flag_char = getopt_long(argc, argv, "-hf:", export_options, &option_index);
+
+    if (flag_char == -1) {
+      break;
+    }
+
+    switch (flag_char) {
+      case 'f':
+        options.format = optarg;
+        if (!is_valid(EXPORT_FORMAT_NAMES, options.format)) {
+          print_export_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'h':
+        print_export_usage();
+        exit(EXIT_SUCCESS);
+        break;
+
+      case 1:
+        if (options.trace != "") {
+          print_export_usage();
+          exit(EXIT_FAILURE);
+        }
+        options.trace = optarg;
+        break;
+
+      default:
+        print_export_usage();
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (options.trace == "") {
+    print_export_usage();
+    exit(EXIT_FAILURE);
+  }
+
+  return options;
+}
+
+
+void print_microbenchmark_usage() {
+  cout <<
+      "Usage: sim microbench [-h] [-a algorithm] [-n max_depth] [-o operations]\n"
+      "\n"
+      "Times each scheduler's enqueue, get_next_thread, preempt (dequeue then\n"
+      "enqueue the same thread) and size operations at ready-queue depths of\n"
+      "1, 10, 100 and so on, without the event engine.\n"
+      "\n"
+      "Options:\n"
+      "  -h, --help:\n"
+      "      Print this help message and exit.\n"
+      "  -a, --algorithm <algorithm>:\n"
+      "      Only benchmark this scheduler (default: all of them).\n"
+      "  -n, --max_depth <depth>:\n"
+      "      The deepest ready queue to benchmark (default 1000000).\n"
+      "  -o, --operations <count>:\n"
+      "      How many times to time each operation at each depth\n"
+      "      (default 100000).\n";
+}
+
+
+MicrobenchmarkOptions parse_microbenchmark_flags(int argc, char** argv) {
+  MicrobenchmarkOptions options;
+
+  static struct option microbenchmark_options[] = {
+    {"algorithm",  required_argument, 0, 'a'},
+    {"max_depth",  required_argument, 0, 'n'},
+    {"operations", required_argument, 0, 'o'},
+    {"help",       no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+  };
+
+  int option_index;
+  char flag_char;
+
+  while (true) {
+    flag_char = getopt_long(argc, argv, "ha:n:o:", microbenchmark_options,
+                            &option_index);
+
+    if (flag_char == -1) {
+      break;
+    }
+
+    switch (flag_char) {
+      case 'a':
+        options.algorithm = optarg;
+        if (!is_valid(SCHEDULER_NAMES, options.algorithm)) {
+          print_microbenchmark_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'n':
+        options.max_depth = parse_count(optarg);
+        if (options.max_depth == 0) {
+          print_microbenchmark_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'o':
+        options.operations = parse_count(optarg);
+        if (options.operations == 0) {
+          print_microbenchmark_usage();
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case 'h':
+        print_microbenchmark_usage();
+        exit(EXIT_SUCCESS);
+        break;
+
+      default:
+        print_microbenchmark_usage();
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (optind < argc) {
+    print_microbenchmark_usage();
+    exit(EXIT_FAILURE);
+  }
+
+  return options;
+}
+
+
+bool parse_sweep_range(const string& text, SweepRange& range) {
+  size_t equals = text.find('=');
+  if (equals == string::npos) return false;
+
+  range.parameter = text.substr(0, equals);
+  if (range.parameter != "quantum" && range.parameter != "thread_switch"
+      && range.parameter != "process_switch") {
+    return false;
+  }
+
+  // accepts "first..last:step", "first..last" or "first"
+  const char* values = text.c_str() + equals + 1;
+  unsigned long first, last, step = 1;
+  int consumed = 0;
+  if (!isdigit(values[0])) return false;
+  if (sscanf(values, "%lu..%lu:%lu%n", &first, &last, &step, &consumed) != 3
+      || values[consumed] != '\0') {
+    step = 1;
+    if (sscanf(values, "%lu..%lu%n", &first, &last, &consumed) != 2
+        || values[consumed] != '\0') {
+      if (sscanf(values, "%lu%n", &first, &consumed) != 1
+          || values[consumed] != '\0') {
+        return false;
+      }
+      last = first;
+    }
+  }
+
+  if (first > last || step == 0) return false;
+  if (range.parameter == "quantum" && first == 0) return false;
+
+  range.first = first;
+  range.last = last;
+  range.step = step;
+  return true;
+}
+
+
+Scheduler* instantiate_scheduler(const string& name,
+                                 const SchedulerOptions& options) {
+  Scheduler* scheduler = nullptr;
+
+  if (name == "FCFS") {
     scheduler = new FcfsScheduler();
-  } else if (option == "RR") {
-    scheduler = new RoundRobinScheduler(3);
-  } else if (option == "PRIORITY") {
+  } else if (name == "RR") {
+    scheduler = new RoundRobinScheduler(options.time_slice);
+  } else if (name == "PRIORITY") {
     scheduler = new PriorityScheduler();
-  } else if (option == "MLFQ") {
-    scheduler = new MultilevelFeedbackScheduler();
-  } else {
-    print_usage();
-    exit(EXIT_FAILURE);
+  } else if (name == "MLFQ") {
+    scheduler = new MultilevelFeedbackScheduler(options.time_slice);
+  } else if (name == "SRTF") {
+    scheduler = new SrtfScheduler();
+  } else if (name == "SPN") {
+    scheduler = new SpnScheduler(options.alpha, options.initial_guess);
+  } else if (name == "CFS") {
+    scheduler = new CfsScheduler(options.target_latency,
+                                 options.min_granularity);
   }
 
   return scheduler;
 }
+
+
+EventQueue* instantiate_event_queue(const string& name) {
+  EventQueue* event_queue = nullptr;
+
+  if (name == "CALENDAR") {
+    event_queue = new CalendarEventQueue();
+  } else if (name == "HEAP") {
+    event_queue = new BinaryHeapEventQueue();
+  }
+
+  return event_queue;
+}
+
+
+Tokenizer* instantiate_tokenizer(const string& name, const string& filename) {
+  Tokenizer* tokenizer = nullptr;
+
+  if (name == "MMAP") {
+    tokenizer = new MappedTokenizer(filename);
+  } else if (name == "ISTREAM") {
+    tokenizer = new StreamTokenizer(filename);
+  }
+
+  return tokenizer;
+}
@@ -1,15 +1,147 @@
+#pragma once
 #include <string>
+#include <vector>
 #include "algorithms/scheduler.h"
+#include "event_queues/event_queue.h"
+#include "util/tokenizer.h"
+#include "util/workload_generator.h"
+
+
+/**
+ * A range of values to try for one parameter in a --sweep.
+ */
+struct SweepRange {
+  /**
+   * The name of the parameter: quantum, thread_switch or process_switch.
+   */
+  std::string parameter;
+
+  /**
+   * The first value in the range.
+   */
+  size_t first;
+
+  /**
+   * The last value in the range (inclusive).
+   */
+  size_t last;
+
+  /**
+   * The difference between consecutive values in the range.
+   */
+  size_t step = 1;
+};
+
+
+/**
+ * The time slice used by the preemptive schedulers unless told otherwise.
+ */
+const size_t DEFAULT_TIME_SLICE = 3;
+
+
+/**
+ * The settings of the schedulers that have any.
+ */
+struct SchedulerOptions {
+  /**
+   * The time slice of the preemptive schedulers.
+   */
+  size_t time_slice = DEFAULT_TIME_SLICE;
+
+  /**
+   * The weight SPN gives a thread's latest burst when predicting its next
+   * one, between 0 and 1.
+   */
+  double alpha = 0.5;
+
+  /**
+   * The length SPN predicts for a thread's first burst.
+   */
+  double initial_guess = 10;
+
+  /**
+   * The period in which CFS tries to give every ready thread a turn.
+   */
+  size_t target_latency = 24;
+
+  /**
+   * The shortest time slice CFS gives a thread.
+   */
+  size_t min_granularity = DEFAULT_TIME_SLICE;
+};
 
 
 struct FlagOptions {
   std::string filename;
-  bool verbose;
-  bool detailed;
-  Scheduler* scheduler = nullptr;
+  bool verbose = false;
+  bool detailed = false;
+  bool engine_stats = false;
+  bool compare = false;
+  bool stream = false;
+  bool background_parse = false;
+  bool parse_only = false;
+  bool cache = false;
+  bool convert = false;
+  bool fast_forward = true;
+  bool verify_fast_forward = false;
+  bool fused_dispatch = true;
+  std::string output;
+  std::string trace;
+  std::string algorithm = "FCFS";
+  SchedulerOptions scheduler;
+  std::string event_queue = "CALENDAR";
+  std::string parser = "MMAP";
+  std::vector<SweepRange> sweep;
 };
 
 
+struct BenchmarkOptions {
+  std::string baseline;
+  std::string corpus = "bench/corpus";
+  std::string event_queue = "CALENDAR";
+  bool update = false;
+  size_t repeats = 5;
+  double tolerance = 0.30;
+};
+
+
+struct ExportOptions {
+  std::string trace;
+  std::string format = "CHROME";
+};
+
+
+struct MicrobenchmarkOptions {
+  std::string algorithm;
+  size_t max_depth = 1000000;
+  size_t operations = 100000;
+};
+
+
+/**
+ * The names of all scheduling algorithms accepted by --algorithm.
+ */
+extern const std::vector<std::string> SCHEDULER_NAMES;
+
+
+/**
+ * The names of all event queues accepted by --event_queue.
+ */
+extern const std::vector<std::string> EVENT_QUEUE_NAMES;
+
+
+/**
+ * The names of all parsers accepted by --parser.
+ */
+extern const std::vector<std::string> PARSER_NAMES;
+
+
+/**
+ * The names of all formats accepted by the export command.
+ */
+extern const std::vector<std::string> EXPORT_FORMAT_NAMES;
+
+
 /**
  * Prints information about how to use this program.
  */
@@ -24,6 +156,80 @@ FlagOptions parse_flags(int argc, char** argv);
 
 
 /**
- * Returns a new instance of a scheduler, as specified by the flags.
+ * Prints information about how to use the generate command.
+ */
+void print_generator_usage();
+
+
+/**
+ * Parses the flags of the generate command. `argv[0]` is the word "generate".
+ */
+GeneratorOptions parse_generator_flags(int argc, char** argv);
+
+
+/**
+ * Prints information about how to use the bench command.
+ */
+void print_benchmark_usage();
+
+
+/**
+ * Parses the flags of the bench command. `argv[0]` is the word "bench".
+ */
+BenchmarkOptions parse_benchmark_flags(int argc, char** argv);
+
+
+/**
+ * Prints information about how to use the export command.
+ */
+void print_export_usage();
+
+
+/**
+ * Parses the flags of the export command. `argv[0]` is the word "export".
+ */
+ExportOptions parse_export_flags(int argc, char** argv);
+
+
+/**
+ * Prints information about how to use the microbench command.
+ */
+void print_microbenchmark_usage();
+
+
+/**
+ * Parses the flags of the microbench command. `argv[0]` is the word
+ * "microbench".
+ */
+MicrobenchmarkOptions parse_microbenchmark_flags(int argc, char** argv);
+
+
+/**
+ * Parses a sweep range of the form name=first..last[:step] or name=value,
+ * returning false if it is malformed.
+ */
+bool parse_sweep_range(const std::string& text, SweepRange& range);
+
+
+/**
+ * Returns a new instance of the named scheduler with the given settings, or
+ * NULL if there is no scheduler with that name.
+ */
+Scheduler* instantiate_scheduler(
+    const std::string& name,
+    const SchedulerOptions& options = SchedulerOptions());
+
+
+/**
+ * Returns a new instance of the named event queue, or NULL if there is no
+ * event queue with that name.
+ */
+EventQueue* instantiate_event_queue(const std::string& name);
+
+
+/**
+ * Returns a new tokenizer of the named kind reading the given file, or NULL
+ * if there is no parser with that name.
  */
-Scheduler* instantiate_scheduler();
+Tokenizer* instantiate_tokenizer(const std::string& name,
+                                 const std::string& filename);
@@ -3,17 +3,20 @@
 #include "types/event.h"
 #include <boost/format.hpp>
 #include <cstdio>
+#include <functional>
 #include <sstream>
 #include <iostream>
+#include <unistd.h>
 
 using namespace std;
 using boost::format;
 
 
-const char* COLOR_MAP[3] = {
+const char* COLOR_MAP[4] = {
   "\033[1;32m",
   "\033[1;30m",
-  "\033[1;37m"
+  "\033[1;37m",
+  "\033[1;31m"
 };
 
 
@@ -46,60 +49,170 @@ const char* EVENT_MAP[8] = {
 };
 
 
-void Logger::print_verbose(
-    const Event* event,
-    Thread* thread,
-    string message) const {
-  if (!verbose){
-    return;
+Logger::Logger(bool verbose, bool per_thread, bool engine_stats)
+    : verbose(verbose),
+      per_thread(per_thread),
+      engine_stats(engine_stats),
+      use_color(isatty(STDOUT_FILENO)) {
+  if (verbose) {
+    // anything already printed must come out before the trace
+    cout.flush();
+    trace = make_shared<TraceWriter>(STDOUT_FILENO);
   }
+}
+
+
+void Logger::trace_colored(Color color, const char* text) const {
+  if (use_color) trace->append(COLOR_MAP[color]);
+  trace->append(text);
+  if (use_color) trace->append("\033[0m");
+}
 
-  format fmt(
-      "At time %d:\n"
-      "    %s\n"
-      "    Thread %d in process %d %s\n"
-      "    %s\n\n");
 
+void Logger::print_verbose_header(const Event* event, const Thread* thread) const {
   Color color = (event->type == Event::DISPATCHER_INVOKED) ? LIGHT_GRAY : GREEN;
 
-  cout << fmt
-      % event->time
-      % colorize(color, EVENT_MAP[event->type])
-      % thread->id
-      % thread->process->pid
-      % colorize(GRAY, "[%s]", PROCESS_TYPE_MAP[thread->process->type])
-      % message;
+  trace->append("At time ");
+  trace->append_int(event->time);
+  trace->append(":\n    ");
+  trace_colored(color, EVENT_MAP[event->type]);
+  trace->append("\n    Thread ");
+  trace->append_int(thread->id);
+  trace->append(" in process ");
+  trace->append_int(thread->pid);
+  trace->append(" ");
+  if (use_color) trace->append(COLOR_MAP[GRAY]);
+  trace->append("[");
+  trace->append(PROCESS_TYPE_MAP[thread->type]);
+  trace->append("]");
+  if (use_color) trace->append("\033[0m");
+  trace->append("\n    ");
 }
 
 
-void Logger::print_state_transition(
+void Logger::trace_state_transition(
     const Event* event,
+    const Thread* thread,
     Thread::State before_state,
     Thread::State after_state) const {
-  format message("Transitioned from %s to %s");
+  print_verbose_header(event, thread);
+  trace->append("Transitioned from ");
+  trace->append(STATE_MAP[before_state]);
+  trace->append(" to ");
+  trace->append(STATE_MAP[after_state]);
+  trace->append("\n\n");
+}
+
+
+void Logger::trace_dispatch(
+    const Event* event,
+    const Thread* thread,
+    const SchedulingDecision* decision) const {
+  const Explanation& explanation = decision->explanation;
+  print_verbose_header(event, thread);
+
+  switch (explanation.kind) {
+  case Explanation::NONE:
+    break;
+
+  case Explanation::RUN_TO_COMPLETION:
+    trace->append("Selected from ");
+    trace->append_int(explanation.candidates);
+    trace->append(" threads; will run to completion of burst");
+    break;
+
+  case Explanation::TIME_SLICED:
+    trace->append("Selected from ");
+    trace->append_int(explanation.candidates);
+    trace->append(" threads; will run for at most ");
+    trace->append_int(decision->time_slice);
+    trace->append(" ticks");
+    break;
+
+  case Explanation::PRIORITY_QUEUE:
+    trace->append("Selected from queue ");
+    trace->append_int(explanation.level);
+    trace->append(" [S:");
+    trace->append_int(explanation.queue_sizes[Process::SYSTEM]);
+    trace->append(" I:");
+    trace->append_int(explanation.queue_sizes[Process::INTERACTIVE]);
+    trace->append(" N:");
+    trace->append_int(explanation.queue_sizes[Process::NORMAL]);
+    trace->append(" B:");
+    trace->append_int(explanation.queue_sizes[Process::BATCH]);
+    trace->append("]");
+    break;
+
+  case Explanation::FEEDBACK_LEVEL:
+    trace->append("Selected from ");
+    trace->append_int(explanation.candidates);
+    trace->append(" threads in level ");
+    trace->append_int(explanation.level + 1);
+    trace->append("/");
+    trace->append_int(explanation.num_levels);
+    trace->append("; will run for at most ");
+    trace->append_int(decision->time_slice);
+    trace->append(" ticks");
+    break;
+
+  case Explanation::SHORTEST_REMAINING:
+    trace->append("Selected from ");
+    trace->append_int(explanation.candidates);
+    trace->append(" threads; has the least time left in its burst (");
+    trace->append_int((long) explanation.key);
+    trace->append(" ticks)");
+    break;
+
+  case Explanation::SHORTEST_PREDICTED: {
+    char predicted[32];
+    snprintf(predicted, sizeof(predicted), "%.2f", explanation.key);
+    trace->append("Selected from ");
+    trace->append_int(explanation.candidates);
+    trace->append(" threads; has the shortest predicted burst (");
+    trace->append(predicted);
+    trace->append(" ticks)");
+    break;
+  }
+
+  case Explanation::FAIR_SHARE: {
+    char vruntime[32];
+    snprintf(vruntime, sizeof(vruntime), "%.2f", explanation.key);
+    trace->append("Selected from ");
+    trace->append_int(explanation.candidates);
+    trace->append(" threads; has the least virtual runtime (");
+    trace->append(vruntime);
+    trace->append(" ticks); will run for at most ");
+    trace->append_int(decision->time_slice);
+    trace->append(" ticks");
+    break;
+  }
+  }
+
+  trace->append("\n\n");
+}
 
-  message
-      % STATE_MAP[before_state]
-      % STATE_MAP[after_state];
 
-  print_verbose(event, event->thread, message.str());
+void Logger::flush() const {
+  if (trace) trace->flush();
 }
 
 
-void Logger::print_process_details(Process* process) const {
+void Logger::print_process_details(
+    const Process& process,
+    const vector<Thread>& threads) const {
   if (!per_thread) {
     return;
   }
 
   cout << format("%s %s:\n")
-      % colorize(LIGHT_GRAY, "Process %d", process->pid)
-      % colorize(GRAY, "[%s]", PROCESS_TYPE_MAP[process->type]);
+      % colorize(LIGHT_GRAY, "Process %d", process.pid)
+      % colorize(GRAY, "[%s]", PROCESS_TYPE_MAP[process.type]);
 
   format thread_format(
     "    Thread %d:  ARR: %-6lu CPU: %-6lu I/O: %-6lu TRT: %-6lu END: %-6lu\n");
 
-  for (size_t i = 0; i < process->threads.size(); i++) {
-    Thread* thread = process->threads[i];
+  for (size_t i = 0; i < process.threads.size(); i++) {
+    const Thread* thread = &threads[process.threads[i]];
 
     cout << thread_format
         % thread->id
@@ -154,8 +267,238 @@ void Logger::print_statistics(SystemStats stats) const {
 }
 
 
+void Logger::print_comparison(
+    const vector<string>& names,
+    const vector<SystemStats>& results) const {
+  // prints one labelled row with a value from each simulation
+  auto print_row = [&](const char* label, const char* value_fmt,
+                       function<double(const SystemStats&)> value) {
+    cout << format("    %-24s") % label;
+    for (const SystemStats& stats : results) {
+      cout << format(value_fmt) % value(stats);
+    }
+    cout << "\n";
+  };
+
+  cout << colorize(GREEN, "COMPARISON COMPLETED!\n\n");
+
+  cout << format("    %-24s") % "";
+  for (const string& name : names) {
+    cout << format(" %12s") % name;
+  }
+  cout << "\n\n";
+
+  for (int i = Process::SYSTEM; i <= Process::BATCH; i++) {
+    cout << colorize(GRAY, "%s THREADS:", PROCESS_TYPE_MAP[i]) << "\n";
+    print_row("Total count:", " %12.0lf",
+              [i](const SystemStats& s) { return (double)s.thread_counts[i]; });
+    print_row("Avg response time:", " %12.2lf",
+              [i](const SystemStats& s) { return s.avg_thread_response_times[i]; });
+    print_row("Avg turnaround time:", " %12.2lf",
+              [i](const SystemStats& s) { return s.avg_thread_turnaround_times[i]; });
+    cout << "\n";
+  }
+
+  print_row("Total elapsed time:", " %12.0lf",
+            [](const SystemStats& s) { return (double)s.total_time; });
+  print_row("Total service time:", " %12.0lf",
+            [](const SystemStats& s) { return (double)s.service_time; });
+  print_row("Total I/O time:", " %12.0lf",
+            [](const SystemStats& s) { return (double)s.io_time; });
+  print_row("Total dispatch time:", " %12.0lf",
+            [](const SystemStats& s) { return (double)s.dispatch_time; });
+  print_row("Total idle time:", " %12.0lf",
+            [](const SystemStats& s) { return (double)s.total_idle_time; });
+  cout << "\n";
+  print_row("CPU utilization:", " %11.2lf%%",
+            [](const SystemStats& s) { return s.cpu_utilization; });
+  print_row("CPU efficiency:", " %11.2lf%%",
+            [](const SystemStats& s) { return s.cpu_efficiency; });
+
+  cout << endl;
+}
+
+
+void Logger::print_csv_header(const vector<string>& parameters) const {
+  for (const string& parameter : parameters) {
+    cout << parameter << ",";
+  }
+  cout << "total_time,service_time,io_time,dispatch_time,idle_time,"
+          "cpu_utilization,cpu_efficiency";
+  for (int i = Process::SYSTEM; i <= Process::BATCH; i++) {
+    cout << format(",%1%_count,%1%_avg_response,%1%_avg_turnaround")
+        % PROCESS_TYPE_MAP[i];
+  }
+  cout << "\n";
+}
+
+
+void Logger::print_csv_row(
+    const vector<string>& values,
+    const SystemStats& stats) const {
+  for (const string& value : values) {
+    cout << value << ",";
+  }
+  cout << format("%lu,%lu,%lu,%lu,%lu,%.2lf,%.2lf")
+      % stats.total_time
+      % stats.service_time
+      % stats.io_time
+      % stats.dispatch_time
+      % stats.total_idle_time
+      % stats.cpu_utilization
+      % stats.cpu_efficiency;
+  for (int i = Process::SYSTEM; i <= Process::BATCH; i++) {
+    cout << format(",%lu,%.2lf,%.2lf")
+        % stats.thread_counts[i]
+        % stats.avg_thread_response_times[i]
+        % stats.avg_thread_turnaround_times[i];
+  }
+  cout << "\n";
+}
+
+
+void Logger::print_benchmark_header() const {
+  cout << format("%-10s %10s %12s %10s %14s %10s %12s %9s\n")
+      % "ALGORITHM" % "PROCESSES" % "EVENTS" % "SECONDS" % "EVENTS/SEC"
+      % "RSS (MB)" % "ALLOCATIONS" % "CHANGE";
+}
+
+
+void Logger::print_benchmark_row(
+    const BenchmarkResult& result,
+    const BenchmarkResult* baseline,
+    const string& regressions,
+    const string& warnings) const {
+  const EngineStats& stats = result.stats;
+  cout << format("%-10s %10lu %12lu %10.3lf %14.0lf %10.1lf %12lu")
+      % result.algorithm
+      % result.num_processes
+      % stats.num_events
+      % stats.seconds
+      % stats.events_per_second
+      % (stats.peak_rss_kb / 1024.0)
+      % stats.num_allocations;
+
+  if (baseline != nullptr && baseline->stats.events_per_second > 0) {
+    double change = stats.events_per_second / baseline->stats.events_per_second - 1;
+    cout << format(" %+8.1lf%%") % (change * 100);
+  } else {
+    cout << format(" %9s") % "-";
+  }
+
+  if (!regressions.empty()) {
+    cout << "  " << colorize(RED, regressions);
+  }
+  if (!warnings.empty()) {
+    cout << "  " << colorize(GRAY, warnings);
+  }
+  cout << "\n";
+}
+
+
+void Logger::print_microbenchmark_header() const {
+  cout << format("%-10s %8s %12s %12s %12s %12s %12s %12s\n")
+      % "ALGORITHM" % "DEPTH" % "ENQUEUE ns" % "DEQUEUE ns" % "PREEMPT ns"
+      % "SIZE ns" % "ENQ ALLOCS" % "DEQ ALLOCS";
+}
+
+
+void Logger::print_microbenchmark_row(
+    const string& algorithm,
+    size_t depth,
+    double enqueue_ns,
+    double dequeue_ns,
+    double preempt_ns,
+    double size_ns,
+    double enqueue_allocations,
+    double dequeue_allocations) const {
+  cout << format("%-10s %8lu %12.1lf %12.1lf %12.1lf %12.1lf %12.3lf %12.3lf\n")
+      % algorithm % depth % enqueue_ns % dequeue_ns % preempt_ns % size_ns
+      % enqueue_allocations % dequeue_allocations;
+}
+
+
+void Logger::print_parse_stats(
+    const Workload& workload,
+    size_t bytes,
+    double seconds) const {
+  format parse_fmt(
+      "%s\n"
+      "    %-20s %12lu\n"
+      "    %-20s %12lu\n"
+      "    %-20s %12lu\n"
+      "    %-20s %12lu\n"
+      "    %-20s %12.4lf\n"
+      "    %-20s %12.2lf\n\n");
+
+  cout << parse_fmt
+      % colorize(GREEN, "PARSE COMPLETED!")
+      % "Processes:" % workload.processes.size()
+      % "Threads:" % workload.threads.size()
+      % "Bursts:" % workload.bursts.size()
+      % "Bytes:" % bytes
+      % "Seconds:" % seconds
+      % "MB/s:" % (seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+}
+
+
+void Logger::print_engine_stats(EngineStats stats) const {
+  if (!engine_stats) {
+    return;
+  }
+
+  format engine_fmt(
+      "%s\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12.4lf\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12.4lf\n"
+      "    %-24s %12lu\n"
+      "    %-24s %12.4lf\n"
+      "    %-24s %12.0lf\n\n");
+
+  cout << engine_fmt
+      % colorize(GRAY, "ENGINE STATISTICS:")
+      % "Events processed:" % stats.num_events
+      % "Events skipped:" % stats.skipped_events
+      % "Events fused:" % stats.fused_events
+      % "Events cancelled:" % stats.cancelled_events
+      % "Preemptions:" % stats.num_preemptions
+      % "Dispatches:" % stats.num_dispatches
+      % "Queued per dispatch:" % stats.queued_events_per_dispatch
+      % "Heap allocations:" % stats.num_allocations
+      % "Decision slabs:" % stats.decision_slabs
+      % "Allocations per event:" % stats.allocations_per_event
+      % "Peak RSS (KB):" % stats.peak_rss_kb
+      % "Seconds:" % stats.seconds
+      % "Events per second:" % stats.events_per_second;
+}
+
+
+void Logger::print_scheduler_metrics(
+    const vector<SchedulerMetric>& metrics) const {
+  if (metrics.empty()) {
+    return;
+  }
+
+  cout << colorize(GRAY, "SCHEDULER STATISTICS:") << "\n";
+  for (const SchedulerMetric& metric : metrics) {
+    string metric_fmt = "    %-24s %12." + to_string(metric.decimals) + "lf\n";
+    cout << format(metric_fmt) % metric.label % metric.value;
+  }
+  cout << endl;
+}
+
+
 template<typename T>
 string Logger::colorize(Color color, T text) const {
+  if (!use_color) return (format("%s") % text).str();
   return (format("%s%s%s") % COLOR_MAP[color] % text % "\033[0m").str();
 }
 
@@ -1,24 +1,43 @@
 #pragma once
+#include <memory>
 #include <string>
+#include <vector>
+#include "types/engine_stats.h"
 #include "types/event.h"
 #include "types/process.h"
+#include "types/scheduler_metric.h"
 #include "types/thread.h"
 #include "types/scheduling_decision.h"
+#include "types/benchmark_result.h"
 #include "types/system_stats.h"
+#include "types/workload.h"
+#include "util/trace_writer.h"
+
+
+/**
+ * The names of each Thread::State, Event::Type and Process::Type, as printed.
+ */
+extern const char* STATE_MAP[5];
+extern const char* EVENT_MAP[8];
+extern const char* PROCESS_TYPE_MAP[4];
 
 
 enum Color {
   GREEN,
   GRAY,
-  LIGHT_GRAY
+  LIGHT_GRAY,
+  RED
 };
 
 
 class Logger {
 public:
 
-  Logger(bool verbose, bool per_thread)
-      : verbose(verbose), per_thread(per_thread) {}
+  /**
+   * Verbose output is written to stdout by a background thread. Colors are
+   * only used when stdout is a terminal.
+   */
+  Logger(bool verbose, bool per_thread, bool engine_stats);
 
   /**
    * If 'verbose' is set to true, outputs a human-readable message indicating
@@ -27,28 +46,125 @@ public:
    */
   void print_state_transition(
       const Event* event,
+      const Thread* thread,
       Thread::State before_state,
-      Thread::State after_state) const;
+      Thread::State after_state) const {
+    if (verbose) trace_state_transition(event, thread, before_state, after_state);
+  }
 
   /**
-   * Outputs a message if 'verbose' is true.
+   * If 'verbose' is set to true, outputs the scheduler's explanation of the
+   * given decision, which was made by the dispatcher at the time of the given
+   * event.
    */
-  void print_verbose(
+  void print_dispatch(
       const Event* event,
-      Thread* thread,
-      std::string message) const;
+      const Thread* thread,
+      const SchedulingDecision* decision) const {
+    if (verbose) trace_dispatch(event, thread, decision);
+  }
+
+  /**
+   * Returns whether every state transition and decision is being output.
+   */
+  bool is_verbose() const { return verbose; }
+
+  /**
+   * Waits until all verbose output has been written. Must be called before
+   * printing anything else after verbose output.
+   */
+  void flush() const;
 
   /**
    * If 'per_thread' is set to true, outputs detailed information about a
    * process and its threads.
    */
-  void print_process_details(Process* process) const;
+  void print_process_details(
+      const Process& process,
+      const std::vector<Thread>& threads) const;
 
   /**
    * Print overall statistics for the simulation.
    */
   void print_statistics(SystemStats stats) const;
 
+  /**
+   * Print the overall statistics of several simulations side by side, one
+   * column per name.
+   */
+  void print_comparison(
+      const std::vector<std::string>& names,
+      const std::vector<SystemStats>& results) const;
+
+  /**
+   * Print the CSV header for print_csv_row(), starting with the given
+   * parameter columns.
+   */
+  void print_csv_header(const std::vector<std::string>& parameters) const;
+
+  /**
+   * Print one CSV row of overall statistics, starting with the given parameter
+   * values.
+   */
+  void print_csv_row(
+      const std::vector<std::string>& values,
+      const SystemStats& stats) const;
+
+  /**
+   * Print the column headings for print_benchmark_row().
+   */
+  void print_benchmark_header() const;
+
+  /**
+   * Print one benchmark result, with its change in events per second relative
+   * to the baseline result if there is one, the reasons it counts as a
+   * regression if there are any, and any warnings that do not.
+   */
+  void print_benchmark_row(
+      const BenchmarkResult& result,
+      const BenchmarkResult* baseline,
+      const std::string& regressions,
+      const std::string& warnings) const;
+
+  /**
+   * Print the column headings for print_microbenchmark_row().
+   */
+  void print_microbenchmark_header() const;
+
+  /**
+   * Print the cost of each scheduler operation at one ready-queue depth, in
+   * nanoseconds per operation, along with the heap allocations per enqueue and
+   * per dequeue.
+   */
+  void print_microbenchmark_row(
+      const std::string& algorithm,
+      size_t depth,
+      double enqueue_ns,
+      double dequeue_ns,
+      double preempt_ns,
+      double size_ns,
+      double enqueue_allocations,
+      double dequeue_allocations) const;
+
+  /**
+   * Print the size of a parsed workload and how quickly it was parsed.
+   */
+  void print_parse_stats(
+      const Workload& workload,
+      size_t bytes,
+      double seconds) const;
+
+  /**
+   * If 'engine_stats' is set to true, outputs counters describing the work
+   * done by the simulator itself.
+   */
+  void print_engine_stats(EngineStats stats) const;
+
+  /**
+   * Outputs the figures a scheduler kept about its run, if it kept any.
+   */
+  void print_scheduler_metrics(const std::vector<SchedulerMetric>& metrics) const;
+
 private:
 
   /**
@@ -61,6 +177,48 @@ private:
    */
   bool per_thread;
 
+  /**
+   * Whether to display statistics about the simulator itself.
+   */
+  bool engine_stats;
+
+  /**
+   * Whether to emit ANSI color codes.
+   */
+  bool use_color;
+
+  /**
+   * Writes verbose output, if verbose. Shared by copies of this logger, which
+   * must not print verbose output from more than one thread at a time.
+   */
+  std::shared_ptr<TraceWriter> trace;
+
+  /**
+   * Writes the opening lines of a verbose message, up to the indentation of
+   * the message itself.
+   */
+  void print_verbose_header(const Event* event, const Thread* thread) const;
+
+  /**
+   * The bodies of print_state_transition() and print_dispatch(), kept out of
+   * line so that the disabled check costs only a branch.
+   */
+  void trace_state_transition(
+      const Event* event,
+      const Thread* thread,
+      Thread::State before_state,
+      Thread::State after_state) const;
+
+  void trace_dispatch(
+      const Event* event,
+      const Thread* thread,
+      const SchedulingDecision* decision) const;
+
+  /**
+   * Appends the given text to the trace in the given color.
+   */
+  void trace_colored(Color color, const char* text) const;
+
   /**
    * Formats the given text as using the given ANSI color code.
    */
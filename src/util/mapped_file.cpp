@@ -0,0 +1,42 @@
+#include "util/mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+MappedFile::MappedFile(const string& filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return;
+  }
+
+  length = info.st_size;
+  // mmap() refuses empty mappings, but an empty file is still a valid file
+  if (length > 0) {
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      return;
+    }
+    // the file is read front to back, so ask for aggressive read-ahead
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(mapping);
+  }
+
+  close(fd);
+  open = true;
+}
+
+
+MappedFile::~MappedFile() {
+  if (bytes != nullptr) {
+    munmap(const_cast<char*>(bytes), length);
+  }
+}
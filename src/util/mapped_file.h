@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+
+/**
+ * A read-only memory mapping of an entire file.
+ */
+class MappedFile {
+public:
+
+  /**
+   * Maps the given file into memory. Check is_open() to see if it succeeded.
+   */
+  explicit MappedFile(const std::string& filename);
+
+  /**
+   * Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Returns true if the file was opened and mapped successfully.
+   */
+  bool is_open() const { return open; }
+
+  /**
+   * Returns the first byte of the file.
+   */
+  const char* data() const { return bytes; }
+
+  /**
+   * Returns the size of the file in bytes.
+   */
+  size_t size() const { return length; }
+
+private:
+
+  /**
+   * The start of the mapping, or NULL if the file is empty or not open.
+   */
+  const char* bytes = nullptr;
+
+  /**
+   * The size of the file in bytes.
+   */
+  size_t length = 0;
+
+  /**
+   * Whether the file was opened successfully.
+   */
+  bool open = false;
+};
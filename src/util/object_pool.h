@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/**
+ * A slab allocator for objects of a single type. Storage is carved out of
+ * fixed-size slabs, and released objects are threaded onto a free list so that
+ * once the pool has warmed up, acquiring and releasing objects never touches
+ * the heap.
+ */
+template <typename T>
+class ObjectPool {
+public:
+
+  /**
+   * Creates a pool whose slabs hold the given number of objects each.
+   */
+  explicit ObjectPool(size_t slab_size = 256) : slab_size(slab_size) {}
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  /**
+   * Constructs a new object in the pool from the given arguments.
+   */
+  template <typename... Args>
+  T* acquire(Args&&... args) {
+    if (free_list == nullptr) grow();
+    Slot* slot = free_list;
+    free_list = slot->next;
+    in_use++;
+    return new (&slot->storage) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Destroys an object previously returned by acquire() and recycles its
+   * storage. Releasing NULL does nothing.
+   */
+  void release(const T* object) {
+    if (object == nullptr) return;
+    object->~T();
+    Slot* slot = reinterpret_cast<Slot*>(const_cast<T*>(object));
+    slot->next = free_list;
+    free_list = slot;
+    in_use--;
+  }
+
+  /**
+   * Returns the number of slabs that have been allocated from the heap.
+   */
+  size_t slab_count() const { return slabs.size(); }
+
+  /**
+   * Returns the number of objects that are currently acquired.
+   */
+  size_t size() const { return in_use; }
+
+private:
+
+  /**
+   * Storage for a single object, or a link in the free list when unused.
+   */
+  union Slot {
+    Slot* next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  /**
+   * Allocates a new slab and adds all of its slots to the free list.
+   */
+  void grow() {
+    slabs.emplace_back(new Slot[slab_size]);
+    Slot* slab = slabs.back().get();
+    for (size_t i = 0; i < slab_size; i++) {
+      slab[i].next = free_list;
+      free_list = &slab[i];
+    }
+  }
+
+  /**
+   * The number of objects in each slab.
+   */
+  const size_t slab_size;
+
+  /**
+   * All slabs owned by this pool.
+   */
+  std::vector<std::unique_ptr<Slot[]>> slabs;
+
+  /**
+   * The head of the list of unused slots.
+   */
+  Slot* free_list = nullptr;
+
+  /**
+   * The number of objects that are currently acquired.
+   */
+  size_t in_use = 0;
+};
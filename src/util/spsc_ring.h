@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/**
+ * A bounded, lock-free ring buffer for passing values from exactly one
+ * producer thread to exactly one consumer thread.
+ */
+template <typename T>
+class SpscRing {
+public:
+
+  /**
+   * Creates a ring that holds up to `capacity` values, rounded up to a power
+   * of two.
+   */
+  explicit SpscRing(size_t capacity) : head(0), tail(0) {
+    size_t size = 1;
+    while (size < capacity) size *= 2;
+    slots.resize(size);
+    mask = size - 1;
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  /**
+   * Moves a value into the ring. Returns false, leaving the value untouched,
+   * if the ring is full. Only called by the producer.
+   */
+  bool try_push(T& value) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == slots.size()) return false;
+    slots[t & mask] = std::move(value);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Moves the oldest value out of the ring. Returns false if the ring is
+   * empty. Only called by the consumer.
+   */
+  bool try_pop(T& value) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) return false;
+    value = std::move(slots[h & mask]);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+
+  /**
+   * Storage for the values in the ring.
+   */
+  std::vector<T> slots;
+
+  /**
+   * slots.size() - 1, used to wrap positions into the ring.
+   */
+  size_t mask;
+
+  /**
+   * The number of values popped so far. Written only by the consumer.
+   */
+  std::atomic<size_t> head;
+
+  /**
+   * Keeps `head` and `tail` on separate cache lines, so that the producer and
+   * consumer don't slow each other down.
+   */
+  char padding[64];
+
+  /**
+   * The number of values pushed so far. Written only by the producer.
+   */
+  std::atomic<size_t> tail;
+};
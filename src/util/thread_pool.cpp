@@ -0,0 +1,105 @@
+#include "util/thread_pool.h"
+
+using namespace std;
+
+
+ThreadPool::ThreadPool(size_t num_threads) : next_queue(0) {
+  if (num_threads == 0) num_threads = thread::hardware_concurrency();
+  if (num_threads == 0) num_threads = 1;
+
+  for (size_t i = 0; i < num_threads; i++) {
+    queues.emplace_back(new TaskQueue());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    workers.emplace_back(&ThreadPool::work, this, i);
+  }
+}
+
+
+ThreadPool::~ThreadPool() {
+  wait();
+  {
+    lock_guard<mutex> lock(state_mutex);
+    stopping = true;
+  }
+  task_available.notify_all();
+  for (thread& worker : workers) worker.join();
+}
+
+
+void ThreadPool::submit(function<void()> task) {
+  // count the task first, so that no worker can take it and finish it before
+  // it has been counted
+  {
+    lock_guard<mutex> lock(state_mutex);
+    queued++;
+    unfinished++;
+  }
+
+  TaskQueue& queue = *queues[next_queue++ % queues.size()];
+  {
+    lock_guard<mutex> lock(queue.mutex);
+    queue.tasks.push_back(move(task));
+  }
+  task_available.notify_one();
+}
+
+
+void ThreadPool::wait() {
+  unique_lock<mutex> lock(state_mutex);
+  all_finished.wait(lock, [this] { return unfinished == 0; });
+}
+
+
+bool ThreadPool::take_task(size_t index, function<void()>& task) {
+  // the worker's own queue is used like a stack, which keeps recently queued
+  // work on the same core
+  {
+    TaskQueue& own = *queues[index];
+    lock_guard<mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  // steal the oldest task from the next non-empty queue
+  for (size_t i = 1; i < queues.size(); i++) {
+    TaskQueue& victim = *queues[(index + i) % queues.size()];
+    lock_guard<mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+void ThreadPool::work(size_t index) {
+  while (true) {
+    function<void()> task;
+
+    if (!take_task(index, task)) {
+      // nothing to run; sleep until a task is submitted. The task may not be
+      // in a queue yet when a worker wakes, in which case it just looks again.
+      unique_lock<mutex> lock(state_mutex);
+      task_available.wait(lock, [this] { return stopping || queued > 0; });
+      if (stopping && queued == 0) return;
+      continue;
+    }
+
+    {
+      lock_guard<mutex> lock(state_mutex);
+      queued--;
+    }
+
+    task();
+
+    lock_guard<mutex> lock(state_mutex);
+    if (--unfinished == 0) all_finished.notify_all();
+  }
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * A fixed-size pool of worker threads that run submitted tasks. Each worker
+ * has its own task queue; submitted tasks are spread across the queues, and a
+ * worker whose queue runs dry steals from the other end of another worker's
+ * queue, so uneven task lengths still keep every core busy.
+ */
+class ThreadPool {
+public:
+
+  /**
+   * Starts the given number of worker threads, or one per hardware thread if
+   * zero is given.
+   */
+  explicit ThreadPool(size_t num_threads = 0);
+
+  /**
+   * Waits for all submitted tasks to finish, then stops the workers.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Queues a task to be run on one of the workers.
+   */
+  void submit(std::function<void()> task);
+
+  /**
+   * Blocks until every submitted task has finished.
+   */
+  void wait();
+
+  /**
+   * Returns the number of worker threads.
+   */
+  size_t size() const { return workers.size(); }
+
+private:
+
+  /**
+   * The tasks waiting to be run by a single worker.
+   */
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  /**
+   * The main loop of the worker with the given index.
+   */
+  void work(size_t index);
+
+  /**
+   * Takes the most recently queued task from the worker's own queue, or
+   * failing that the oldest task from another worker's queue. Returns false if
+   * every queue is empty.
+   */
+  bool take_task(size_t index, std::function<void()>& task);
+
+  /**
+   * The worker threads.
+   */
+  std::vector<std::thread> workers;
+
+  /**
+   * One task queue per worker.
+   */
+  std::vector<std::unique_ptr<TaskQueue>> queues;
+
+  /**
+   * The queue that the next submitted task is added to.
+   */
+  std::atomic<size_t> next_queue;
+
+  /**
+   * The number of tasks that have been submitted but not yet taken.
+   */
+  size_t queued = 0;
+
+  /**
+   * The number of tasks that have been submitted but not yet finished.
+   */
+  size_t unfinished = 0;
+
+  /**
+   * Whether the workers should exit once every queue is empty.
+   */
+  bool stopping = false;
+
+  /**
+   * Guards the counters and flag above.
+   */
+  std::mutex state_mutex;
+
+  /**
+   * Signalled when a task is submitted or the pool is stopping.
+   */
+  std::condition_variable task_available;
+
+  /**
+   * Signalled when the last unfinished task finishes.
+   */
+  std::condition_variable all_finished;
+};
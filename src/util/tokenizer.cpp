@@ -0,0 +1,77 @@
+#include "util/tokenizer.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+
+void Tokenizer::report(const string& message) const {
+  if (deferred) throw ParseError(message);
+  cerr << message << endl;
+  exit(EXIT_FAILURE);
+}
+
+
+StreamTokenizer::StreamTokenizer(const string& filename)
+    : filename(filename), file(filename.c_str()) {
+  if (!file) {
+    cerr << "Unable to open simulation file: " << filename << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  file.seekg(0, ios::end);
+  length = file.tellg();
+  file.seekg(0, ios::beg);
+}
+
+
+long StreamTokenizer::next_integer(const char* what) {
+  long value;
+  tokens++;
+  if (!(file >> value)) {
+    fail(string("expected ") + what);
+  }
+  return value;
+}
+
+
+void StreamTokenizer::fail(const string& message) const {
+  report(filename + ": token " + to_string(tokens) + ": " + message);
+}
+
+
+MappedTokenizer::MappedTokenizer(const string& filename)
+    : filename(filename), file(filename) {
+  if (!file.is_open()) {
+    cerr << "Unable to open simulation file: " << filename << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  pos = file.data();
+  end = file.data() + file.size();
+  token_start = pos;
+}
+
+
+void MappedTokenizer::fail_expected(const char* what) const {
+  if (token_start == end) {
+    fail(string("expected ") + what + ", found end of file");
+  }
+  fail(string("expected ") + what);
+}
+
+
+void MappedTokenizer::fail(const string& message) const {
+  // count the lines before the token, which is only worth doing on failure
+  size_t line = 1;
+  const char* line_start = file.data();
+  for (const char* c = file.data(); c < token_start; c++) {
+    if (*c == '\n') {
+      line++;
+      line_start = c + 1;
+    }
+  }
+
+  report(filename + ":" + to_string(line) + ":"
+         + to_string(token_start - line_start + 1) + ": " + message);
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include "util/mapped_file.h"
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+
+/**
+ * Thrown by a tokenizer that fails while its failures are deferred. what()
+ * is the message, with its location, that would otherwise have been printed.
+ */
+struct ParseError : std::runtime_error {
+  explicit ParseError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+
+/**
+ * Abstract base class for splitting a simulation file into integers.
+ */
+class Tokenizer {
+public:
+
+  /**
+   * Returns the next integer in the input. If the input ends or holds
+   * something other than an integer, exits with an error saying that `what`
+   * was expected.
+   */
+  virtual long next_integer(const char* what) = 0;
+
+  /**
+   * Prints the given message along with the location of the most recently
+   * read token, then exits. If failures are deferred, throws a ParseError
+   * holding the same text instead.
+   */
+  [[noreturn]] virtual void fail(const std::string& message) const = 0;
+
+  /**
+   * Returns the size of the input in bytes, or 0 if it is not known.
+   */
+  virtual size_t size() const = 0;
+
+  /**
+   * Makes fail() throw rather than exit, for a tokenizer read on a thread
+   * other than the main one, where exiting would tear down the program
+   * under the main thread's feet.
+   */
+  void defer_failures() { deferred = true; }
+
+  /**
+   * Virtual destructor (as a best practice).
+   */
+  virtual ~Tokenizer() {}
+
+protected:
+
+  /**
+   * Prints a message that already says where the problem is and exits, or
+   * throws it if failures are deferred.
+   */
+  [[noreturn]] void report(const std::string& message) const;
+
+private:
+
+  /**
+   * Whether fail() throws rather than exits.
+   */
+  bool deferred = false;
+};
+
+
+/**
+ * A tokenizer that reads integers with istream::operator>>.
+ */
+class StreamTokenizer final : public Tokenizer {
+public:
+
+  /**
+   * Opens the given file, exiting if it cannot be opened.
+   */
+  explicit StreamTokenizer(const std::string& filename);
+
+
+  virtual long next_integer(const char* what) override;
+
+
+  [[noreturn]] virtual void fail(const std::string& message) const override;
+
+
+  virtual size_t size() const override { return length; }
+
+private:
+
+  /**
+   * The name of the file, for error messages.
+   */
+  std::string filename;
+
+  /**
+   * The size of the file in bytes.
+   */
+  size_t length = 0;
+
+  /**
+   * The file being read.
+   */
+  std::ifstream file;
+
+  /**
+   * The number of integers read so far.
+   */
+  size_t tokens = 0;
+};
+
+
+/**
+ * A tokenizer that memory-maps the file and scans integers by hand, which
+ * avoids the locale and stream-state overhead of operator>>. Only the start of
+ * each token is recorded; its line and column are worked out if it fails.
+ */
+class MappedTokenizer final : public Tokenizer {
+public:
+
+  /**
+   * Maps the given file, exiting if it cannot be opened.
+   */
+  explicit MappedTokenizer(const std::string& filename);
+
+
+  /**
+   * Defined inline below so that a reader holding a MappedTokenizer, rather
+   * than a Tokenizer, can scan without a call per token.
+   */
+  virtual long next_integer(const char* what) override;
+
+
+  [[noreturn]] virtual void fail(const std::string& message) const override;
+
+
+  virtual size_t size() const override { return file.size(); }
+
+private:
+
+  /**
+   * Fails because the token at `token_start` is not the integer `what`.
+   * Kept out of line so that next_integer() stays small.
+   */
+  [[noreturn]] void fail_expected(const char* what) const;
+
+  /**
+   * The name of the file, for error messages.
+   */
+  std::string filename;
+
+  /**
+   * The mapped contents of the file.
+   */
+  MappedFile file;
+
+  /**
+   * The next character to be scanned.
+   */
+  const char* pos;
+
+  /**
+   * One past the last character in the file.
+   */
+  const char* end;
+
+  /**
+   * The start of the most recently read token.
+   */
+  const char* token_start;
+};
+
+
+inline long MappedTokenizer::next_integer(const char* what) {
+  // scan with locals, which the compiler can keep in registers
+  const char* p = pos;
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) {
+    p++;
+  }
+
+  token_start = p;
+  if (p == end) fail_expected(what);
+
+  bool negative = (*p == '-');
+  if (negative) p++;
+
+  const char* digits = p;
+  unsigned long value = 0;
+  while (p < end && (unsigned)(*p - '0') < 10) {
+    value = value * 10 + (*p - '0');
+    p++;
+  }
+
+  // 18 digits always fit in a long
+  if (p == digits || p - digits > 18
+      || (p < end && *p != ' ' && *p != '\n' && *p != '\t' && *p != '\r')) {
+    fail_expected(what);
+  }
+
+  pos = p;
+  return negative ? -(long)value : (long)value;
+}
@@ -0,0 +1,100 @@
+#include "util/trace_writer.h"
+#include <cerrno>
+#include <unistd.h>
+
+using namespace std;
+
+
+TraceWriter::TraceWriter(int fd, size_t buffer_size, size_t num_buffers)
+    : fd(fd), current(buffer_size), full(num_buffers), empty(num_buffers),
+      finished(0), stopping(false) {
+  // the writer thread hasn't started yet, so it's safe to fill its ring here
+  for (size_t i = 1; i < num_buffers; i++) {
+    vector<char> buffer(buffer_size);
+    empty.try_push(buffer);
+  }
+  writer = thread(&TraceWriter::write_buffers, this);
+}
+
+
+TraceWriter::~TraceWriter() {
+  flush();
+  {
+    lock_guard<mutex> lock(idle_mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  writer.join();
+}
+
+
+void TraceWriter::append_int(long value) {
+  char digits[24];
+  char* end = digits + sizeof(digits);
+  char* start = end;
+  unsigned long magnitude = value < 0 ? -(unsigned long) value : value;
+  do {
+    *--start = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0) *--start = '-';
+  append(start, end - start);
+}
+
+
+void TraceWriter::hand_off() {
+  // the buffer records how much of it is used in its size, and is grown back
+  // to full size when it returns
+  size_t capacity = current.size();
+  current.resize(used);
+  while (!full.try_push(current)) this_thread::yield();
+  handed_off++;
+  // taking the lock orders the push before the writer's check for work
+  {
+    lock_guard<mutex> lock(idle_mutex);
+  }
+  wake.notify_one();
+
+  while (!empty.try_pop(current)) this_thread::yield();
+  current.resize(capacity);
+  used = 0;
+}
+
+
+void TraceWriter::flush() {
+  if (used > 0) hand_off();
+  while (finished.load(memory_order_acquire) < handed_off) {
+    this_thread::yield();
+  }
+}
+
+
+void TraceWriter::write_buffers() {
+  vector<char> buffer;
+  while (true) {
+    if (!full.try_pop(buffer)) {
+      // sleep until a buffer arrives rather than polling, which would take
+      // time away from the producer on a machine with few cores
+      unique_lock<mutex> lock(idle_mutex);
+      while (!full.try_pop(buffer)) {
+        if (stopping) return;
+        wake.wait(lock);
+      }
+    }
+
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+    while (remaining > 0) {
+      ssize_t written = write(fd, data, remaining);
+      // give up on the rest of the buffer if the output has gone away
+      if (written < 0 && errno != EINTR) break;
+      if (written > 0) {
+        data += written;
+        remaining -= written;
+      }
+    }
+
+    while (!empty.try_push(buffer)) this_thread::yield();
+    finished.fetch_add(1, memory_order_release);
+  }
+}
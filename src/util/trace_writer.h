@@ -0,0 +1,121 @@
+#pragma once
+#include "util/spsc_ring.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Buffers text written by one thread and writes it to a file descriptor from a
+ * background thread. Text is appended to a preallocated buffer. Full buffers
+ * are handed to the writer through a lock-free ring, written with one large
+ * write() each, and handed back through a second ring for reuse. Appending
+ * therefore never allocates and never waits on I/O unless every buffer is in
+ * flight.
+ */
+class TraceWriter {
+public:
+
+  /**
+   * Starts a writer for the given file descriptor with `num_buffers` buffers
+   * of `buffer_size` bytes each.
+   */
+  explicit TraceWriter(int fd, size_t buffer_size = 1 << 18,
+                       size_t num_buffers = 8);
+
+  /**
+   * Writes any buffered text, then stops the background thread.
+   */
+  ~TraceWriter();
+
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  /**
+   * Appends the given bytes.
+   */
+  void append(const char* text, size_t length) {
+    while (length > 0) {
+      if (used == current.size()) hand_off();
+      size_t chunk = std::min(length, current.size() - used);
+      memcpy(current.data() + used, text, chunk);
+      used += chunk;
+      text += chunk;
+      length -= chunk;
+    }
+  }
+
+  /**
+   * Appends a NUL-terminated string.
+   */
+  void append(const char* text) { append(text, strlen(text)); }
+
+  /**
+   * Appends the decimal representation of an integer.
+   */
+  void append_int(long value);
+
+  /**
+   * Blocks until everything appended so far has been written.
+   */
+  void flush();
+
+private:
+
+  /**
+   * Passes the current buffer to the writer and takes an empty one.
+   */
+  void hand_off();
+
+  /**
+   * The main loop of the background thread.
+   */
+  void write_buffers();
+
+  /**
+   * The file descriptor that text is written to.
+   */
+  int fd;
+
+  /**
+   * The buffer being appended to, and how much of it is in use.
+   */
+  std::vector<char> current;
+  size_t used = 0;
+
+  /**
+   * Full buffers, waiting to be written.
+   */
+  SpscRing<std::vector<char>> full;
+
+  /**
+   * Written buffers, cleared and ready for reuse.
+   */
+  SpscRing<std::vector<char>> empty;
+
+  /**
+   * The number of buffers handed to and finished by the writer so far.
+   */
+  size_t handed_off = 0;
+  std::atomic<size_t> finished;
+
+  /**
+   * Set by the destructor to stop the writer once it has drained the ring.
+   */
+  std::atomic<bool> stopping;
+
+  /**
+   * Wakes the writer when a full buffer or `stopping` is set while it sleeps.
+   */
+  std::mutex idle_mutex;
+  std::condition_variable wake;
+
+  /**
+   * The background thread.
+   */
+  std::thread writer;
+};
@@ -0,0 +1,334 @@
+#include "util/workload_generator.h"
+#include "types/workload.h"
+#include "util/binary_workload.h"
+#include "util/thread_pool.h"
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+
+using namespace std;
+
+
+const vector<string> ARRIVAL_PROCESS_NAMES = {"POISSON", "BURSTY", "DIURNAL"};
+
+
+const vector<string> BURST_DISTRIBUTION_NAMES = {
+  "EXPONENTIAL", "UNIFORM", "PARETO"
+};
+
+
+/**
+ * The number of processes generated by one task.
+ */
+static const size_t CHUNK_SIZE = 1024;
+
+
+/**
+ * The longest burst that will be generated, so heavy tails cannot overflow.
+ */
+static const double MAX_BURST = 1e9;
+
+
+/**
+ * Returns a generator for one of several independent streams of random
+ * numbers derived from the seed.
+ */
+static mt19937_64 make_rng(uint64_t seed, uint64_t stream) {
+  seed_seq sequence{(uint32_t) seed, (uint32_t) (seed >> 32),
+                    (uint32_t) stream, (uint32_t) (stream >> 32)};
+  return mt19937_64(sequence);
+}
+
+
+/**
+ * Produces thread arrival times in increasing order. Arrivals depend on
+ * everything that came before them, so a single clock is run on the calling
+ * thread while the workers fill in everything else.
+ */
+class ArrivalClock {
+public:
+
+  ArrivalClock(const GeneratorOptions& options)
+      : options(options), rng(make_rng(options.seed, 0)) {}
+
+  /**
+   * Returns the arrival time of the next thread.
+   */
+  double next() {
+    double mean = options.mean_interarrival;
+
+    if (options.arrivals == "BURSTY") {
+      // Alternate between bursts at five times the mean rate and lulls at
+      // 5/9 of it, switching after 50 arrivals on average. Both states last
+      // equally long in arrivals, so the overall mean interarrival is kept.
+      if (bernoulli_distribution(1.0 / 50)(rng)) bursting = !bursting;
+      mean *= bursting ? 0.2 : 1.8;
+    } else if (options.arrivals == "DIURNAL") {
+      // Thin a Poisson process at the peak rate down to a rate that swings
+      // 80% either side of the mean over each period.
+      const double amplitude = 0.8;
+      double peak_rate = (1 + amplitude) / mean;
+      while (true) {
+        time += exponential_distribution<double>(peak_rate)(rng);
+        double rate = (1 + amplitude * sin(2 * M_PI * time / options.period))
+            / mean;
+        if (uniform_real_distribution<double>(0, peak_rate)(rng) < rate) {
+          return time;
+        }
+      }
+    }
+
+    time += exponential_distribution<double>(1 / mean)(rng);
+    return time;
+  }
+
+private:
+
+  const GeneratorOptions& options;
+
+  mt19937_64 rng;
+
+  /**
+   * The most recent arrival time.
+   */
+  double time = 0;
+
+  /**
+   * Whether a BURSTY clock is in a burst.
+   */
+  bool bursting = false;
+};
+
+
+/**
+ * A run of consecutive processes generated by a single task.
+ */
+struct Chunk {
+  /**
+   * The index of the chunk, which seeds its random choices.
+   */
+  size_t index;
+
+  /**
+   * The PID of the first process in the chunk.
+   */
+  int first_pid;
+
+  /**
+   * The number of threads in each process, chosen on the calling thread.
+   */
+  vector<size_t> thread_counts;
+
+  /**
+   * The arrival time of each thread, chosen on the calling thread.
+   */
+  vector<int> arrivals;
+
+  /**
+   * The generated processes, with indices relative to the chunk.
+   */
+  Workload part;
+
+  /**
+   * The text form of `part`, when writing text.
+   */
+  string text;
+};
+
+
+// appends the decimal digits of a non-negative value, then the separator
+static void append_int(string& text, long value, char separator) {
+  char digits[24];
+  int length = 0;
+  do {
+    digits[length++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+
+  while (length > 0) text += digits[--length];
+  text += separator;
+}
+
+
+// draws a burst length with the configured distribution and mean
+static int draw_burst(const GeneratorOptions& options, double mean,
+                      mt19937_64& rng) {
+  double length;
+  if (options.burst_distribution == "UNIFORM") {
+    length = uniform_real_distribution<double>(0, 2 * mean)(rng);
+  } else if (options.burst_distribution == "PARETO") {
+    // shape 2 keeps the mean finite; the scale is half the mean
+    double u = 1 - uniform_real_distribution<double>(0, 1)(rng);
+    length = (mean / 2) / sqrt(u);
+  } else {
+    length = exponential_distribution<double>(1 / mean)(rng);
+  }
+
+  return (int) max(1.0, min(MAX_BURST, round(length)));
+}
+
+
+// fills in everything about the chunk that was not chosen up front
+static void fill_chunk(const GeneratorOptions& options, Chunk& chunk) {
+  mt19937_64 rng = make_rng(options.seed, chunk.index + 2);
+  discrete_distribution<int> types(options.type_mix.begin(),
+                                   options.type_mix.end());
+  geometric_distribution<int> extra_bursts(1 / options.mean_cpu_bursts);
+
+  Workload& part = chunk.part;
+  const double mean_io_burst = options.mean_cpu_burst * options.io_ratio;
+  size_t next_arrival = 0;
+
+  for (size_t p = 0; p < chunk.thread_counts.size(); p++) {
+    ProcessSpec process;
+    process.pid = chunk.first_pid + p;
+    process.type = (Process::Type) types(rng);
+    process.first_thread = part.threads.size();
+    process.num_threads = chunk.thread_counts[p];
+
+    if (!options.binary) {
+      chunk.text += '\n';
+      append_int(chunk.text, process.pid, ' ');
+      append_int(chunk.text, process.type, ' ');
+      append_int(chunk.text, process.num_threads, '\n');
+    }
+
+    for (size_t t = 0; t < process.num_threads; t++) {
+      ThreadSpec thread;
+      thread.id = t;
+      thread.arrival_time = chunk.arrivals[next_arrival++];
+      thread.process = part.processes.size();
+      thread.first_burst = part.bursts.size();
+      size_t num_cpu_bursts = 1 + extra_bursts(rng);
+      thread.num_bursts = num_cpu_bursts * 2 - 1;
+
+      for (size_t b = 0; b < thread.num_bursts; b++) {
+        part.bursts.push_back(draw_burst(
+            options, b % 2 == 0 ? options.mean_cpu_burst : mean_io_burst, rng));
+      }
+
+      if (!options.binary) {
+        chunk.text += '\n';
+        append_int(chunk.text, thread.arrival_time, ' ');
+        append_int(chunk.text, num_cpu_bursts, '\n');
+        for (size_t b = 0; b < thread.num_bursts; b++) {
+          append_int(chunk.text, part.bursts[thread.first_burst + b],
+                     b % 2 == 0 && b + 1 < thread.num_bursts ? ' ' : '\n');
+        }
+      }
+
+      part.threads.push_back(thread);
+    }
+
+    part.processes.push_back(process);
+  }
+
+  // the text is all that is written, so free the tables early
+  if (!options.binary) part = Workload();
+}
+
+
+// chooses the thread counts and arrival times of a chunk
+static void plan_chunk(const GeneratorOptions& options, size_t index,
+                       mt19937_64& rng, ArrivalClock& clock, Chunk& chunk) {
+  uniform_int_distribution<size_t> thread_count(options.min_threads,
+                                                options.max_threads);
+  size_t first = index * CHUNK_SIZE;
+  size_t last = min(first + CHUNK_SIZE, options.num_processes);
+
+  chunk.index = index;
+  chunk.first_pid = first;
+  for (size_t p = first; p < last; p++) {
+    size_t num_threads = thread_count(rng);
+    chunk.thread_counts.push_back(num_threads);
+
+    for (size_t t = 0; t < num_threads; t++) {
+      double arrival = floor(clock.next());
+      if (arrival > INT_MAX) {
+        cerr << "Arrival times exceed " << INT_MAX
+             << "; lower the mean interarrival time" << endl;
+        exit(EXIT_FAILURE);
+      }
+      chunk.arrivals.push_back((int) arrival);
+    }
+  }
+}
+
+
+void generate_workload(const GeneratorOptions& options) {
+  if (options.num_processes > (size_t) INT_MAX + 1) {
+    cerr << "At most " << (size_t) INT_MAX + 1 << " processes can be generated"
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  unique_ptr<BinaryWorkloadWriter> binary;
+  FILE* text = nullptr;
+  if (options.binary) {
+    binary.reset(new BinaryWorkloadWriter(
+        options.output, options.thread_switch_overhead,
+        options.process_switch_overhead, 0));
+  } else {
+    text = fopen(options.output.c_str(), "wb");
+  }
+  if (binary ? !binary->is_open() : text == nullptr) {
+    cerr << "Unable to open output file: " << options.output << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  bool ok = true;
+  if (text != nullptr) {
+    ok = fprintf(text, "%lu %lu %lu\n", options.num_processes,
+                 options.thread_switch_overhead,
+                 options.process_switch_overhead) > 0;
+  }
+
+  auto write_chunks = [&](const vector<Chunk>& chunks) {
+    for (const Chunk& chunk : chunks) {
+      ok = ok && (binary
+          ? binary->append(chunk.part)
+          : fwrite(chunk.text.data(), 1, chunk.text.size(), text)
+              == chunk.text.size());
+    }
+  };
+
+  ThreadPool pool(options.jobs);
+  size_t window = pool.size() * 4;
+  size_t num_chunks = (options.num_processes + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  mt19937_64 plan_rng = make_rng(options.seed, 1);
+  ArrivalClock clock(options);
+
+  // Fill one window of chunks on the pool while the previous window is
+  // written out, so at most two windows are in memory at once.
+  vector<Chunk> filling, written;
+  for (size_t first = 0; first < num_chunks; first += window) {
+    filling.assign(min(window, num_chunks - first), Chunk());
+    for (size_t i = 0; i < filling.size(); i++) {
+      plan_chunk(options, first + i, plan_rng, clock, filling[i]);
+    }
+    for (Chunk& chunk : filling) {
+      pool.submit([&options, &chunk] { fill_chunk(options, chunk); });
+    }
+
+    write_chunks(written);
+    pool.wait();
+    swap(filling, written);
+  }
+  write_chunks(written);
+
+  if (binary) {
+    ok = binary->finish() && ok;
+  } else {
+    ok = (fclose(text) == 0) && ok;
+  }
+
+  if (!ok) {
+    cerr << "Unable to write output file: " << options.output << endl;
+    exit(EXIT_FAILURE);
+  }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ * The names of the arrival processes accepted by the generator.
+ */
+extern const std::vector<std::string> ARRIVAL_PROCESS_NAMES;
+
+
+/**
+ * The names of the burst length distributions accepted by the generator.
+ */
+extern const std::vector<std::string> BURST_DISTRIBUTION_NAMES;
+
+
+/**
+ * Parameters of a synthetic workload. Two runs with the same options produce
+ * byte-identical files, however many worker threads are used.
+ */
+struct GeneratorOptions {
+  /**
+   * The file to write.
+   */
+  std::string output;
+
+  /**
+   * Whether to write the binary format instead of text.
+   */
+  bool binary = false;
+
+  /**
+   * Seeds every random choice.
+   */
+  uint64_t seed = 1;
+
+  /**
+   * The number of processes to generate.
+   */
+  size_t num_processes = 1000;
+
+  /**
+   * The range that each process's number of threads is drawn from uniformly.
+   */
+  size_t min_threads = 1;
+  size_t max_threads = 4;
+
+  /**
+   * Relative weights of SYSTEM, INTERACTIVE, NORMAL and BATCH processes.
+   */
+  std::vector<double> type_mix = {1, 2, 4, 1};
+
+  /**
+   * How thread arrivals are spread over time: POISSON, BURSTY or DIURNAL.
+   */
+  std::string arrivals = "POISSON";
+
+  /**
+   * The mean time between two thread arrivals.
+   */
+  double mean_interarrival = 5;
+
+  /**
+   * The length of one DIURNAL cycle.
+   */
+  double period = 10000;
+
+  /**
+   * The mean number of CPU bursts per thread (geometrically distributed).
+   */
+  double mean_cpu_bursts = 3;
+
+  /**
+   * The distribution of burst lengths: EXPONENTIAL, UNIFORM or PARETO.
+   */
+  std::string burst_distribution = "EXPONENTIAL";
+
+  /**
+   * The mean length of a CPU burst.
+   */
+  double mean_cpu_burst = 15;
+
+  /**
+   * The mean length of an IO burst relative to the mean CPU burst.
+   */
+  double io_ratio = 1.5;
+
+  /**
+   * The dispatch overheads written into the file header.
+   */
+  size_t thread_switch_overhead = 3;
+  size_t process_switch_overhead = 7;
+
+  /**
+   * The number of worker threads, or zero for one per hardware thread.
+   */
+  size_t jobs = 0;
+};
+
+
+/**
+ * Generates a workload and writes it to options.output. Processes are
+ * generated in fixed-size chunks on a thread pool and written in order, so
+ * only a bounded number of chunks is ever held in memory. Threads are written
+ * in arrival order, so the output can be simulated with --stream. Exits with
+ * an error if the output cannot be written.
+ */
+void generate_workload(const GeneratorOptions& options);
@@ -0,0 +1,268 @@
+#include "util/workload_reader.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+
+/**
+ * Describes the range that a value read by read_value() fell outside of.
+ */
+static string range_message(const char* what, long value, long min, long max) {
+  // the default bound only matters to values too large for an int
+  return max == INT_MAX && value < min
+      ? string(what) + " must be at least " + to_string(min)
+      : string(what) + " must be between " + to_string(min) + " and "
+            + to_string(max);
+}
+
+
+/**
+ * Reads an integer and checks that it lies between min and max (inclusive).
+ */
+template <typename TokenizerT>
+static long read_value(TokenizerT& tokens, const char* what, long min,
+                       long max = INT_MAX) {
+  long value = tokens.next_integer(what);
+  if (value < min || value > max) {
+    tokens.fail(range_message(what, value, min, max));
+  }
+  return value;
+}
+
+
+/**
+ * Reads a dispatch overhead, which must not exceed MAX_SWITCH_OVERHEAD.
+ */
+static long read_overhead(Tokenizer& tokens, const char* what) {
+  long value = tokens.next_integer(what);
+  if (value < 0 || value > (long)MAX_SWITCH_OVERHEAD) {
+    tokens.fail(string(what) + " must be between 0 and "
+                + to_string(MAX_SWITCH_OVERHEAD)
+                + ", since it is added to the simulated time on every dispatch");
+  }
+  return value;
+}
+
+
+/**
+ * Reads a single thread from the given tokenizer.
+ */
+template <typename TokenizerT>
+static void read_thread(TokenizerT& tokens, int tid, size_t process,
+                        Workload& workload) {
+  ThreadSpec thread;
+
+  // Read in the thread's arrival time and its number of CPU bursts.
+  thread.arrival_time = read_value(tokens, "arrival time", 0);
+  size_t num_cpu_bursts = read_value(tokens, "number of CPU bursts", 1);
+
+  thread.id = tid;
+  thread.process = process;
+  thread.first_burst = workload.bursts.size();
+  thread.num_bursts = num_cpu_bursts * 2 - 1;
+
+  // Read in each burst in the thread.
+  for (size_t n = 0; n < thread.num_bursts; n++) {
+    workload.bursts.push_back(read_value(tokens, "burst length", 0));
+  }
+
+  workload.threads.push_back(thread);
+}
+
+
+/**
+ * Reads a single process and its threads from the given tokenizer.
+ */
+template <typename TokenizerT>
+static void read_process(TokenizerT& tokens, Workload& workload) {
+  ProcessSpec process;
+
+  // Read in the process ID, its type, and the number of threads.
+  process.pid = read_value(tokens, "process ID", 0);
+  process.type = (Process::Type) read_value(tokens, "process type",
+                                            Process::SYSTEM, Process::BATCH);
+  process.num_threads = read_value(tokens, "number of threads", 0);
+  process.first_thread = workload.threads.size();
+
+  // Read in each thread in the process.
+  for (size_t tid = 0; tid < process.num_threads; tid++) {
+    read_thread(tokens, tid, workload.processes.size(), workload);
+  }
+
+  workload.processes.push_back(process);
+}
+
+
+/**
+ * Reads a whole workload. Instantiated for each tokenizer, so that the calls
+ * for every token are resolved (and inlined) at compile time.
+ */
+template <typename TokenizerT>
+static Workload read_workload_with(TokenizerT& tokens) {
+  Workload workload;
+
+  // Read the total number of processes, as well as the dispatch overheads.
+  size_t num_processes = read_value(tokens, "number of processes", 0);
+  workload.thread_switch_overhead = read_overhead(tokens, "thread switch overhead");
+  workload.process_switch_overhead = read_overhead(tokens, "process switch overhead");
+
+  // Size the tables up front rather than growing them token by token. Every
+  // token takes at least two bytes (a digit and a separator), so the input's
+  // size bounds how many of each there can be, whatever the header claims;
+  // capacity that is never filled is never touched, so it costs address
+  // space rather than memory.
+  size_t max_tokens = tokens.size() / 2;
+  workload.processes.reserve(min(num_processes, max_tokens / 3));
+  workload.threads.reserve(min(num_processes, max_tokens / 3));
+  workload.bursts.reserve(max_tokens);
+
+  // Read in each process.
+  for (size_t p = 0; p < num_processes; p++) {
+    read_process(tokens, workload);
+  }
+
+  return workload;
+}
+
+
+Workload read_workload(Tokenizer& tokens) {
+  // the built-in tokenizers are final, so a successful cast means the exact
+  // type is known
+  if (MappedTokenizer* mapped = dynamic_cast<MappedTokenizer*>(&tokens)) {
+    return read_workload_with(*mapped);
+  }
+  if (StreamTokenizer* stream = dynamic_cast<StreamTokenizer*>(&tokens)) {
+    return read_workload_with(*stream);
+  }
+  return read_workload_with(tokens);
+}
+
+
+WorkloadStream::WorkloadStream(Tokenizer& tokens) : tokens(tokens) {
+  // Read the total number of processes, as well as the dispatch overheads.
+  processes_left = read_value(tokens, "number of processes", 0);
+  thread_switch_overhead = read_overhead(tokens, "thread switch overhead");
+  process_switch_overhead = read_overhead(tokens, "process switch overhead");
+}
+
+
+bool WorkloadStream::next(ThreadRecord& record) {
+  // move on to the next process that has threads
+  while (threads_left == 0) {
+    if (processes_left == 0) return false;
+    processes_left--;
+
+    pid = read_value(tokens, "process ID", 0);
+    type = (Process::Type) read_value(tokens, "process type",
+                                      Process::SYSTEM, Process::BATCH);
+    threads_left = read_value(tokens, "number of threads", 0);
+    next_tid = 0;
+  }
+
+  // Read in the thread's arrival time and its number of CPU bursts.
+  record.arrival_time = read_value(tokens, "arrival time", 0);
+  size_t num_cpu_bursts = read_value(tokens, "number of CPU bursts", 1);
+
+  record.pid = pid;
+  record.type = type;
+  record.id = next_tid++;
+  record.bursts.clear();
+
+  // Read in each burst in the thread. The count is only trusted as far as
+  // the bursts are actually there, so the buffer grows as they are read.
+  for (size_t n = 0; n < num_cpu_bursts * 2 - 1; n++) {
+    record.bursts.push_back(read_value(tokens, "burst length", 0));
+  }
+
+  threads_left--;
+  return true;
+}
+
+
+BackgroundWorkloadStream::BackgroundWorkloadStream(Tokenizer& tokens,
+                                                   size_t capacity)
+    : WorkloadStream(tokens), ring(capacity), finished(false), cancelled(false),
+      parser_waiting(false), reader_waiting(false) {
+  // the header has been read on this thread; anything wrong after it is
+  // found on the parser thread, which leaves it for next() to report
+  tokens.defer_failures();
+
+  parser = thread([this] {
+    ThreadRecord record;
+    try {
+      while (!cancelled && WorkloadStream::next(record)) {
+        if (!ring.try_push(record)) {
+          // sleep until the simulation makes room in the ring
+          unique_lock<mutex> lock(idle_mutex);
+          parser_waiting.store(true);
+          atomic_thread_fence(memory_order_seq_cst);
+          while (!ring.try_push(record)) {
+            if (cancelled) return;
+            wake.wait(lock);
+          }
+          parser_waiting.store(false);
+        }
+        wake_up(reader_waiting);
+      }
+    } catch (const ParseError& problem) {
+      error = problem.what();
+    }
+    finished.store(true, memory_order_release);
+    wake_up(reader_waiting);
+  });
+}
+
+
+BackgroundWorkloadStream::~BackgroundWorkloadStream() {
+  {
+    lock_guard<mutex> lock(idle_mutex);
+    cancelled = true;
+  }
+  wake.notify_all();
+  parser.join();
+}
+
+
+void BackgroundWorkloadStream::wake_up(const atomic<bool>& waiting) {
+  // the fence pairs with the one a sleeper makes between setting its flag
+  // and looking at the ring, so either it sees this change or this sees it
+  // waiting; taking the lock means it is really asleep before it is woken
+  atomic_thread_fence(memory_order_seq_cst);
+  if (waiting.load(memory_order_relaxed)) {
+    lock_guard<mutex> lock(idle_mutex);
+    wake.notify_all();
+  }
+}
+
+
+bool BackgroundWorkloadStream::next(ThreadRecord& record) {
+  bool popped = ring.try_pop(record);
+  if (!popped) {
+    unique_lock<mutex> lock(idle_mutex);
+    reader_waiting.store(true);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (!(popped = ring.try_pop(record))
+           && !finished.load(memory_order_acquire)) {
+      wake.wait(lock);
+    }
+    reader_waiting.store(false);
+    // the ring has to be checked again after seeing the flag, since the last
+    // threads may have been pushed just before it was set
+    if (!popped) popped = ring.try_pop(record);
+  }
+
+  if (popped) {
+    wake_up(parser_waiting);
+    return true;
+  }
+
+  if (!error.empty()) {
+    parser.join();
+    cerr << error << endl;
+    exit(EXIT_FAILURE);
+  }
+  return false;
+}
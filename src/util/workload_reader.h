@@ -0,0 +1,175 @@
+#pragma once
+#include "types/process.h"
+#include "types/workload.h"
+#include "util/spsc_ring.h"
+#include "util/tokenizer.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Reads a whole simulation file into a workload. Exits the program with the
+ * location of the problem if the file is malformed.
+ */
+Workload read_workload(Tokenizer& tokens);
+
+
+/**
+ * A single thread read from a simulation file by a WorkloadStream, together
+ * with the process it belongs to.
+ */
+struct ThreadRecord {
+  int pid;
+  Process::Type type;
+  int id;
+  int arrival_time;
+  std::vector<int> bursts;
+};
+
+
+/**
+ * Reads a simulation file one thread at a time, so that the whole workload
+ * never has to be held in memory.
+ */
+class WorkloadStream {
+public:
+
+  /**
+   * Reads the header from the given tokenizer, which must outlive this
+   * object.
+   */
+  explicit WorkloadStream(Tokenizer& tokens);
+
+  virtual ~WorkloadStream() {}
+
+  /**
+   * Reads the next thread in file order into `record`. Returns false once
+   * every thread has been read.
+   */
+  virtual bool next(ThreadRecord& record);
+
+  /**
+   * The amount of overhead required to switch between two threads within the
+   * same process.
+   */
+  size_t thread_switch_overhead = 0;
+
+  /**
+   * The amount of overhead required to switch between two processes.
+   */
+  size_t process_switch_overhead = 0;
+
+private:
+
+  /**
+   * The tokenizer that the workload is read from.
+   */
+  Tokenizer& tokens;
+
+  /**
+   * The number of processes that have not been started yet.
+   */
+  size_t processes_left = 0;
+
+  /**
+   * The number of threads left to read in the current process.
+   */
+  size_t threads_left = 0;
+
+  /**
+   * The ID that the next thread in the current process will have.
+   */
+  int next_tid = 0;
+
+  /**
+   * The ID of the current process.
+   */
+  int pid = 0;
+
+  /**
+   * The type of the current process.
+   */
+  Process::Type type = Process::SYSTEM;
+};
+
+
+/**
+ * A WorkloadStream that parses the file on a background thread, handing
+ * threads over through a bounded ring buffer so that parsing overlaps with
+ * simulation.
+ */
+class BackgroundWorkloadStream : public WorkloadStream {
+public:
+
+  /**
+   * Reads the header and starts parsing threads on a background thread,
+   * buffering up to `capacity` threads ahead of the reader.
+   */
+  BackgroundWorkloadStream(Tokenizer& tokens, size_t capacity = 4096);
+
+  /**
+   * Stops and joins the background thread.
+   */
+  virtual ~BackgroundWorkloadStream();
+
+  /**
+   * Reads the next thread, waiting for the background thread if it has not
+   * parsed it yet. If the background thread found a problem in the file,
+   * prints it and exits once the threads before it have been read.
+   */
+  virtual bool next(ThreadRecord& record) override;
+
+private:
+
+  /**
+   * Wakes the other thread if it is asleep, as recorded by `waiting`, after
+   * this one has changed something that the other is waiting for.
+   */
+  void wake_up(const std::atomic<bool>& waiting);
+
+  /**
+   * Threads that have been parsed but not yet read.
+   */
+  SpscRing<ThreadRecord> ring;
+
+  /**
+   * Set by the background thread once it has pushed every thread, or has
+   * stopped at a problem in the file.
+   */
+  std::atomic<bool> finished;
+
+  /**
+   * The problem the background thread stopped at, with its location, or
+   * empty. Written before `finished` is set.
+   */
+  std::string error;
+
+  /**
+   * Set by the destructor to make the background thread give up early.
+   */
+  std::atomic<bool> cancelled;
+
+  /**
+   * Set while the background thread sleeps on a full ring, and while the
+   * reader sleeps on an empty one.
+   */
+  std::atomic<bool> parser_waiting;
+  std::atomic<bool> reader_waiting;
+
+  /**
+   * Wakes either thread from its sleep, so that neither spins while the
+   * other is working, which would take time from it on a machine with few
+   * cores.
+   */
+  std::mutex idle_mutex;
+  std::condition_variable wake;
+
+  /**
+   * The background thread.
+   */
+  std::thread parser;
+};